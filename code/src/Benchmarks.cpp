@@ -0,0 +1,475 @@
+/**
+ * @file Benchmarks.cpp
+ * @brief Benchmarks for the file @ref ByteUtilities.hpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ */
+
+#define ANKERL_NANOBENCH_IMPLEMENT
+
+#include <ByteUtilities.hpp>
+#include <nanobench/nanobench.h>
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**************************************************************************************
+ * Benchmark Section for [Entropy coding]
+ **************************************************************************************/
+
+/**
+ * @brief Decode throughput of @ref FseDecode on 16 MiB of bytes with a geometric-like distribution,
+ * roughly 2 bits of entropy per byte. The target is over 1 GB/s on one core.
+ *
+ */
+static void BenchmarkFseDecode() {
+    constexpr size_t BYTES = 16u << 20;
+
+    std::mt19937 rng(54);
+    std::vector<uint8_t> vData(BYTES);
+    for (auto &uByte : vData) uByte = static_cast<uint8_t>(std::countr_zero(uint32_t(rng()) | 0x8000'0000u));
+    const auto vEncoded = ByteUtilities::FseEncode<uint8_t>(vData);
+    std::vector<uint8_t> vOut(BYTES);
+
+    ankerl::nanobench::Bench bench;
+    bench.title("FSE decoding, 16 MiB").unit("byte").batch(BYTES).minEpochIterations(3);
+
+    bench.run("ByteUtilities::FseDecode", [&] {
+        const bool bDecoded = ByteUtilities::FseDecode<uint8_t>(vEncoded, vOut);
+        ankerl::nanobench::doNotOptimizeAway(bDecoded);
+    });
+}
+
+/**************************************************************************************
+ * Benchmark Section for [Priority queue]
+ **************************************************************************************/
+
+/**
+ * @brief Scheduler-like workload: the queue holds a steady number of elements, every operation pushes a
+ * random priority in [0, 4096) and pops the minimum.
+ *
+ */
+static void BenchmarkPriorityQueue() {
+    constexpr size_t HELD = 1024;
+    constexpr size_t OPERATIONS = 1'000'000;
+
+    std::mt19937 rng(67);
+    std::vector<uint16_t> vPriorities(OPERATIONS + HELD);
+    for (auto &uPriority : vPriorities) uPriority = static_cast<uint16_t>(rng() % 4096);
+
+    ankerl::nanobench::Bench bench;
+    bench.title("Priority queue, push + pop min").unit("op").batch(OPERATIONS).minEpochIterations(3).relative(true);
+
+    bench.run("std::priority_queue", [&] {
+        std::priority_queue<std::pair<uint16_t, uint32_t>, std::vector<std::pair<uint16_t, uint32_t>>,
+                            std::greater<std::pair<uint16_t, uint32_t>>>
+            queue;
+        for (size_t i = 0; i < HELD; ++i) queue.emplace(vPriorities[i], uint32_t(i));
+
+        uint64_t uChecksum = 0;
+        for (size_t i = HELD; i < vPriorities.size(); ++i) {
+            queue.emplace(vPriorities[i], uint32_t(i));
+            uChecksum += queue.top().second;
+            queue.pop();
+        }
+        ankerl::nanobench::doNotOptimizeAway(uChecksum);
+    });
+
+    bench.run("ByteUtilities::BucketQueue", [&] {
+        ByteUtilities::BucketQueue<uint32_t> queue;
+        for (size_t i = 0; i < HELD; ++i) queue.Push(vPriorities[i], uint32_t(i));
+
+        uint64_t uChecksum = 0;
+        uint32_t uValue = 0;
+        for (size_t i = HELD; i < vPriorities.size(); ++i) {
+            queue.Push(vPriorities[i], uint32_t(i));
+            queue.PopMin(uValue);
+            uChecksum += uValue;
+        }
+        ankerl::nanobench::doNotOptimizeAway(uChecksum);
+    });
+}
+
+/**************************************************************************************
+ * Benchmark Section for [Lookup tables]
+ **************************************************************************************/
+
+/**
+ * @brief Runs @ref primitive over @ref vInputs alone, then interleaved with random reads of a working
+ * set the size of a typical L1 data cache (32 KiB): the hot loop's own data. The gap between the two
+ * runs of a Table policy, against the same gap for Compute, is the L1 pressure the table adds.
+ *
+ */
+template<typename Primitive>
+static void RunWithWorkingSet(ankerl::nanobench::Bench &bench, const std::string &name,
+                              const std::vector<uint64_t> &vInputs, const std::vector<uint64_t> &vWorkingSet,
+                              const std::vector<uint16_t> &vIndexes, Primitive primitive) {
+    bench.run(name, [&] {
+        uint64_t uChecksum = 0;
+        for (const uint64_t uInput : vInputs) uChecksum += primitive(uInput);
+        ankerl::nanobench::doNotOptimizeAway(uChecksum);
+    });
+
+    bench.run(name + " + 32 KiB working set", [&] {
+        uint64_t uChecksum = 0;
+        for (size_t i = 0; i < vInputs.size(); ++i) uChecksum += primitive(vInputs[i]) + vWorkingSet[vIndexes[i]];
+        ankerl::nanobench::doNotOptimizeAway(uChecksum);
+    });
+}
+
+/**
+ * @brief Compute against Table for every primitive of the lookup tables section, plus a 64 KiB
+ * popcount table that cannot fit in L1 next to anything else.
+ *
+ */
+static void BenchmarkLookupTables() {
+    using LookupPolicy = ByteUtilities::LookupPolicy;
+    constexpr size_t OPERATIONS = 1u << 16;
+
+    std::mt19937_64 rng(70);
+    std::vector<uint64_t> vInputs(OPERATIONS), vWorkingSet(32 * 1024 / sizeof(uint64_t));
+    std::vector<uint16_t> vIndexes(OPERATIONS);
+    for (auto &uInput : vInputs) uInput = rng();
+    for (auto &uWord : vWorkingSet) uWord = rng();
+    for (auto &uIndex : vIndexes) uIndex = static_cast<uint16_t>(rng() % vWorkingSet.size());
+
+    ankerl::nanobench::Bench bench;
+    bench.title("Lookup tables, compute vs table").unit("op").batch(OPERATIONS).minEpochIterations(20);
+
+    RunWithWorkingSet(bench, "ReverseBits<uint64_t> compute", vInputs, vWorkingSet, vIndexes,
+                      [](uint64_t u) { return ByteUtilities::ReverseBits<LookupPolicy::Compute>(u); });
+    RunWithWorkingSet(bench, "ReverseBits<uint64_t> table (256 B)", vInputs, vWorkingSet, vIndexes,
+                      [](uint64_t u) { return ByteUtilities::ReverseBits<LookupPolicy::Table>(u); });
+
+    RunWithWorkingSet(bench, "PopCount<uint64_t> compute", vInputs, vWorkingSet, vIndexes,
+                      [](uint64_t u) { return ByteUtilities::PopCount<LookupPolicy::Compute>(u); });
+    RunWithWorkingSet(bench, "PopCount<uint64_t> table (256 B)", vInputs, vWorkingSet, vIndexes,
+                      [](uint64_t u) { return ByteUtilities::PopCount<LookupPolicy::Table>(u); });
+    RunWithWorkingSet(bench, "PopCount<uint64_t> table (64 KiB)", vInputs, vWorkingSet, vIndexes, [](uint64_t u) {
+        using Table = ByteUtilities::LookupTable<uint8_t, 65536, &ByteUtilities::PopCountEntry>;
+        return Table::VALUES[u & 0xFFFF] + Table::VALUES[(u >> 16) & 0xFFFF] + Table::VALUES[(u >> 32) & 0xFFFF] +
+               Table::VALUES[u >> 48];
+    });
+
+    RunWithWorkingSet(bench, "Crc32c(8 bytes) compute", vInputs, vWorkingSet, vIndexes, [](uint64_t u) {
+        return ByteUtilities::Crc32c<LookupPolicy::Compute>(std::span(reinterpret_cast<const uint8_t *>(&u), 8));
+    });
+    RunWithWorkingSet(bench, "Crc32c(8 bytes) table (1 KiB)", vInputs, vWorkingSet, vIndexes, [](uint64_t u) {
+        return ByteUtilities::Crc32c<LookupPolicy::Table>(std::span(reinterpret_cast<const uint8_t *>(&u), 8));
+    });
+
+    RunWithWorkingSet(bench, "HexDigitValue compute", vInputs, vWorkingSet, vIndexes,
+                      [](uint64_t u) { return ByteUtilities::HexDigitValue<LookupPolicy::Compute>(char(u)); });
+    RunWithWorkingSet(bench, "HexDigitValue table (256 B)", vInputs, vWorkingSet, vIndexes,
+                      [](uint64_t u) { return ByteUtilities::HexDigitValue<LookupPolicy::Table>(char(u)); });
+
+    RunWithWorkingSet(bench, "MortonEncode compute", vInputs, vWorkingSet, vIndexes, [](uint64_t u) {
+        return ByteUtilities::MortonEncode<LookupPolicy::Compute>(uint32_t(u), uint32_t(u >> 32));
+    });
+    RunWithWorkingSet(bench, "MortonEncode table (512 B)", vInputs, vWorkingSet, vIndexes, [](uint64_t u) {
+        return ByteUtilities::MortonEncode<LookupPolicy::Table>(uint32_t(u), uint32_t(u >> 32));
+    });
+}
+
+/**************************************************************************************
+ * Benchmark Section for [Incremental decoding]
+ **************************************************************************************/
+
+/**
+ * @brief Sums the fields of @ref vWidths, the decoding side of @ref BenchmarkBitStreamDecoder.
+ *
+ */
+static ByteUtilities::BitStreamDecoder::Task SumFields(ByteUtilities::BitStreamDecoder &decoder,
+                                                       const std::vector<uint8_t> &vWidths, uint64_t &uSum) {
+    uint64_t uLocalSum = 0;
+    for (const uint8_t uWidth : vWidths) uLocalSum += co_await decoder.ReadBits(uWidth);
+    uSum = uLocalSum;
+}
+
+/**
+ * @brief Same sum as @ref SumFields, read by batches of 256 fields with ReadFields. The sum is a separate
+ * pass in a plain function, the coroutine would keep it in its frame.
+ *
+ */
+static ByteUtilities::BitStreamDecoder::Task SumFieldsBatched(ByteUtilities::BitStreamDecoder &decoder,
+                                                              const std::vector<uint8_t> &vWidths, uint64_t &uSum) {
+    uint64_t aFields[256];
+    uSum = 0;
+    for (size_t i = 0; i < vWidths.size(); i += std::size(aFields)) {
+        const auto widths = std::span(vWidths).subspan(i, std::min(std::size(aFields), vWidths.size() - i));
+        co_await decoder.ReadFields(widths, aFields);
+        uSum = std::accumulate(aFields, aFields + widths.size(), uSum);
+    }
+}
+
+/**
+ * @brief Coroutine decoder against a plain reader over the same contiguous buffer, with the same
+ * accumulator refill. Fields of 1 to 20 bits, 4 KiB chunks from a file read and the whole buffer, read
+ * one co_await per field and by batches with ReadFields, which compares with the plain reader storing
+ * the same batches.
+ *
+ */
+static void BenchmarkBitStreamDecoder() {
+    constexpr size_t FIELDS = 1'000'000;
+
+    std::mt19937 rng(71);
+    std::vector<uint8_t> vWidths(FIELDS);
+    size_t uBits = 0;
+    for (auto &uWidth : vWidths) {
+        uWidth = static_cast<uint8_t>(1 + rng() % 20);
+        uBits += uWidth;
+    }
+    std::vector<uint8_t> vBytes((uBits + 7) / 8 + 8);
+    for (auto &uByte : vBytes) uByte = static_cast<uint8_t>(rng());
+
+    ankerl::nanobench::Bench bench;
+    bench.title("Bit stream decoding, 1 to 20 bits fields").unit("field").batch(FIELDS).minEpochIterations(5);
+    bench.relative(true);
+
+    bench.run("Plain reader", [&] {
+        const uint8_t *pCur = vBytes.data();
+        uint64_t uAcc = 0, uSum = 0;
+        size_t uAccBits = 0;
+        for (const uint8_t uWidth : vWidths) {
+            if (uAccBits < uWidth) {
+                uint64_t uWord;
+                std::memcpy(&uWord, pCur, sizeof(uWord));
+                uAcc |= uWord << uAccBits;
+                pCur += (63 - uAccBits) / 8;
+                uAccBits |= 56;
+            }
+            uSum += uAcc & ((uint64_t(1u) << uWidth) - 1);
+            uAcc >>= uWidth;
+            uAccBits -= uWidth;
+        }
+        ankerl::nanobench::doNotOptimizeAway(uSum);
+    });
+
+    bench.run("Plain reader, 256 fields batches", [&] {
+        const uint8_t *pCur = vBytes.data();
+        uint64_t uAcc = 0, uSum = 0, aFields[256];
+        size_t uAccBits = 0;
+        for (size_t i = 0; i < vWidths.size(); i += std::size(aFields)) {
+            const size_t uCount = std::min(std::size(aFields), vWidths.size() - i);
+            for (size_t k = 0; k < uCount; ++k) {
+                const uint8_t uWidth = vWidths[i + k];
+                if (uAccBits < uWidth) {
+                    uint64_t uWord;
+                    std::memcpy(&uWord, pCur, sizeof(uWord));
+                    uAcc |= uWord << uAccBits;
+                    pCur += (63 - uAccBits) / 8;
+                    uAccBits |= 56;
+                }
+                aFields[k] = uAcc & ((uint64_t(1u) << uWidth) - 1);
+                uAcc >>= uWidth;
+                uAccBits -= uWidth;
+            }
+            uSum = std::accumulate(aFields, aFields + uCount, uSum);
+        }
+        ankerl::nanobench::doNotOptimizeAway(uSum);
+    });
+
+    for (const bool bBatched : {false, true}) {
+        for (const size_t uChunk : {size_t(4096), vBytes.size()}) {
+            const std::string name = std::string(bBatched ? "BitStreamDecoder::ReadFields" : "BitStreamDecoder") +
+                                     (uChunk == 4096 ? ", 4 KiB chunks" : ", one chunk");
+            bench.run(name, [&] {
+                ByteUtilities::BitStreamDecoder decoder;
+                uint64_t uSum = 0;
+                auto task = bBatched ? SumFieldsBatched(decoder, vWidths, uSum) : SumFields(decoder, vWidths, uSum);
+                for (size_t uPos = 0; uPos < vBytes.size(); uPos += uChunk)
+                    decoder.Feed(std::span(vBytes).subspan(uPos, std::min(uChunk, vBytes.size() - uPos)));
+                decoder.Finish();
+                ankerl::nanobench::doNotOptimizeAway(uSum);
+            });
+        }
+    }
+}
+
+/**************************************************************************************
+ * Benchmark Section for [Block decoding]
+ **************************************************************************************/
+
+/**
+ * @brief Decodes 256 MiB worth of 1000 values blocks of 1 to 24 bits with 0 to 7 pool workers, the calling
+ * thread decodes too.
+ *
+ */
+static void BenchmarkDecodeBlocks() {
+    std::mt19937_64 rng(72);
+    std::vector<uint8_t> vFile;
+    std::vector<uint64_t> vValues(1000);
+    size_t uTotalValues = 0;
+    while (uTotalValues < (size_t(256) << 20) / sizeof(uint64_t)) {
+        const size_t uWidth = 1 + rng() % 24;
+        for (auto &uValue : vValues) uValue = rng() & ((uint64_t(1u) << uWidth) - 1);
+        ByteUtilities::EncodeBlock(std::span<const uint64_t>(vValues), vFile);
+        uTotalValues += vValues.size();
+    }
+
+    ankerl::nanobench::Bench bench;
+    bench.title("Block decoding pipeline").unit("value").batch(uTotalValues).minEpochIterations(2);
+    for (const size_t uWorkers : {0u, 1u, 3u, 7u}) {
+        ByteUtilities::ThreadPool pool(uWorkers);
+        bench.run(std::to_string(uWorkers) + " workers", [&] {
+            uint64_t uSum = 0;
+            ByteUtilities::DecodeBlocks(
+                vFile,
+                [&](size_t, std::span<const uint64_t> values) {
+                    for (const uint64_t uValue : values) uSum += uValue;
+                },
+                pool);
+            ankerl::nanobench::doNotOptimizeAway(uSum);
+        });
+    }
+}
+
+/**************************************************************************************
+ * Benchmark Section for [Sharded bitmap]
+ **************************************************************************************/
+
+/**
+ * @brief Marks 2^22 random bits of a 2^24 bits bitmap from 1 to 8 threads: atomic ORs on one shared bitmap,
+ * against private shards merged at the end.
+ *
+ */
+static void BenchmarkShardedBitmap() {
+    constexpr size_t uBits = size_t(1u) << 24;
+    constexpr size_t uMarks = size_t(1u) << 22;
+    std::mt19937_64 rng(74);
+    std::vector<uint32_t> vPositions(uMarks);
+    for (uint32_t &uPosition : vPositions) uPosition = static_cast<uint32_t>(rng() % uBits);
+
+    ankerl::nanobench::Bench bench;
+    bench.title("Concurrent bitmap marking").unit("bit").batch(uMarks).minEpochIterations(2);
+    for (const size_t uThreads : {1u, 2u, 4u, 8u}) {
+        const auto RunThreads = [&](auto fnMark) {
+            std::vector<std::thread> vThreads;
+            for (size_t t = 0; t < uThreads; ++t)
+                vThreads.emplace_back([&, t] {
+                    for (size_t i = t; i < uMarks; i += uThreads) fnMark(t, vPositions[i]);
+                });
+            for (std::thread &thread : vThreads) thread.join();
+        };
+
+        std::vector<std::atomic<uint64_t>> vShared(uBits / 64);
+        bench.run(std::to_string(uThreads) + " threads, shared atomic OR", [&] {
+            RunThreads([&](size_t, uint32_t uPosition) {
+                vShared[uPosition / 64].fetch_or(uint64_t(1u) << (uPosition % 64), std::memory_order_relaxed);
+            });
+            ankerl::nanobench::doNotOptimizeAway(vShared[0].load());
+        });
+
+        ByteUtilities::ShardedBitmap sharded(uBits, uThreads);
+        bench.run(std::to_string(uThreads) + " threads, shards and merge", [&] {
+            RunThreads([&](size_t t, uint32_t uPosition) { sharded.SetBit(t, uPosition); });
+            sharded.Merge();
+            ankerl::nanobench::doNotOptimizeAway(sharded.Words()[0]);
+        });
+    }
+}
+
+/**************************************************************************************
+ * Benchmark Section for [Concurrent Bloom filter]
+ **************************************************************************************/
+
+/**
+ * @brief Inserts 2^20 keys then probes 2^20 keys, half of them absent, split over 1 to 64 threads, with 16
+ * bits per key: the lock-free filter against a reader-writer lock around single calls.
+ *
+ */
+static void BenchmarkConcurrentBloomFilter() {
+    constexpr size_t uKeys = size_t(1u) << 20;
+    std::mt19937_64 rng(75);
+    std::vector<uint64_t> vInserted(uKeys), vProbed(uKeys);
+    for (uint64_t &uKey : vInserted) uKey = rng();
+    for (size_t i = 0; i < uKeys; ++i) vProbed[i] = i % 2 == 0 ? vInserted[i] : rng();
+
+    ankerl::nanobench::Bench bench;
+    bench.title("Concurrent Bloom filter").unit("key").batch(2 * uKeys).minEpochIterations(2);
+    for (const size_t uThreads : {1u, 2u, 4u, 8u, 16u, 32u, 64u}) {
+        const auto RunThreads = [&](auto fnRun) {
+            std::vector<std::thread> vThreads;
+            const size_t uShare = uKeys / uThreads;
+            for (size_t t = 0; t < uThreads; ++t)
+                vThreads.emplace_back([&, t] { fnRun(t * uShare, uShare); });
+            for (std::thread &thread : vThreads) thread.join();
+        };
+
+        ByteUtilities::ConcurrentBloomFilter filter(16 * uKeys);
+        std::vector<uint64_t> vHits((uKeys + 63) / 64);
+        bench.run(std::to_string(uThreads) + " threads, lock-free batches", [&] {
+            RunThreads([&](size_t uBegin, size_t uCount) {
+                filter.InsertBatch(std::span<const uint64_t>(vInserted).subspan(uBegin, uCount));
+            });
+            RunThreads([&](size_t uBegin, size_t uCount) {
+                // Whole words of the hit bitmap per thread
+                filter.MayContainBatch(std::span<const uint64_t>(vProbed).subspan(uBegin, uCount),
+                                       vHits.data() + uBegin / 64);
+            });
+            ankerl::nanobench::doNotOptimizeAway(vHits[0]);
+        });
+
+        ByteUtilities::ConcurrentBloomFilter single(16 * uKeys);
+        bench.run(std::to_string(uThreads) + " threads, lock-free single calls", [&] {
+            std::atomic<size_t> uHits = 0;
+            RunThreads([&](size_t uBegin, size_t uCount) {
+                for (size_t i = uBegin; i < uBegin + uCount; ++i) single.Insert(vInserted[i]);
+            });
+            RunThreads([&](size_t uBegin, size_t uCount) {
+                size_t uLocalHits = 0;
+                for (size_t i = uBegin; i < uBegin + uCount; ++i) uLocalHits += single.MayContain(vProbed[i]);
+                uHits += uLocalHits;
+            });
+            ankerl::nanobench::doNotOptimizeAway(uHits.load());
+        });
+
+        ByteUtilities::ConcurrentBloomFilter locked(16 * uKeys);
+        std::shared_mutex mutex;
+        bench.run(std::to_string(uThreads) + " threads, reader-writer lock", [&] {
+            std::atomic<size_t> uHits = 0;
+            RunThreads([&](size_t uBegin, size_t uCount) {
+                for (size_t i = uBegin; i < uBegin + uCount; ++i) {
+                    const std::unique_lock<std::shared_mutex> lock(mutex);
+                    locked.Insert(vInserted[i]);
+                }
+            });
+            RunThreads([&](size_t uBegin, size_t uCount) {
+                size_t uLocalHits = 0;
+                for (size_t i = uBegin; i < uBegin + uCount; ++i) {
+                    const std::shared_lock<std::shared_mutex> lock(mutex);
+                    uLocalHits += locked.MayContain(vProbed[i]);
+                }
+                uHits += uLocalHits;
+            });
+            ankerl::nanobench::doNotOptimizeAway(uHits.load());
+        });
+    }
+}
+
+int main() {
+    BenchmarkFseDecode();
+    BenchmarkPriorityQueue();
+    BenchmarkLookupTables();
+    BenchmarkBitStreamDecoder();
+    BenchmarkDecodeBlocks();
+    BenchmarkShardedBitmap();
+    BenchmarkConcurrentBloomFilter();
+
+    return 0;
+}
@@ -13,6 +13,25 @@
 #include <ByteUtilities.hpp>
 #include <doctest/doctest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <bitset>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <queue>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
 /**************************************************************************************
  * Test Section for [Bit operation]
  **************************************************************************************/
@@ -208,3 +227,2088 @@ TEST_SUITE("[Byte operation]") {
         delete pInt;
     }
 }
+
+/**************************************************************************************
+ * Test Section for [Delta encoding]
+ **************************************************************************************/
+
+TEST_SUITE("[Delta encoding]") {
+    TEST_CASE("Xor delta round trip") {
+        std::mt19937 rng(51);
+        std::vector<uint8_t> vOld(10'000);
+        for (auto &uByte : vOld) uByte = static_cast<uint8_t>(rng());
+
+        std::vector<uint8_t> vNew = vOld;
+        vNew[0] ^= 0x01;
+        vNew[37] = 0xAB;
+        for (size_t i = 4000; i < 4100; ++i) vNew[i] = static_cast<uint8_t>(i);
+        vNew[9999] ^= 0xFF;
+
+        const auto vPatch = ByteUtilities::XorDelta(vOld, vNew);
+        REQUIRE(vPatch.size() < 200);
+
+        REQUIRE(ByteUtilities::ApplyXorDelta(vOld, vPatch));
+        REQUIRE(vOld == vNew);
+    }
+
+    TEST_CASE("Xor delta of equal buffers") {
+        const std::vector<uint8_t> vData(1000, 0x5A);
+        const auto vPatch = ByteUtilities::XorDelta(vData, vData);
+
+        // Only the size header: 1000 as a varint
+        REQUIRE(vPatch.size() == 2);
+
+        std::vector<uint8_t> vCopy = vData;
+        REQUIRE(ByteUtilities::ApplyXorDelta(vCopy, vPatch));
+        REQUIRE(vCopy == vData);
+    }
+
+    TEST_CASE("Xor delta invalid input") {
+        const std::vector<uint8_t> vA(16, 0);
+        const std::vector<uint8_t> vB(17, 0);
+        REQUIRE(ByteUtilities::XorDelta(vA, vB).empty());
+
+        std::vector<uint8_t> vNew = vA;
+        vNew[3] = 7;
+        auto vPatch = ByteUtilities::XorDelta(vA, vNew);
+
+        // Wrong buffer size
+        std::vector<uint8_t> vOther(17, 0);
+        REQUIRE_FALSE(ByteUtilities::ApplyXorDelta(vOther, vPatch));
+
+        // Truncated patch leaves the buffer untouched
+        vPatch.pop_back();
+        std::vector<uint8_t> vTarget = vA;
+        REQUIRE_FALSE(ByteUtilities::ApplyXorDelta(vTarget, vPatch));
+        REQUIRE(vTarget == vA);
+    }
+}
+
+/**************************************************************************************
+ * Test Section for [Run-length encoding]
+ **************************************************************************************/
+
+TEST_SUITE("[Run-length encoding]") {
+    TEST_CASE("Rle round trip") {
+        std::mt19937 rng(52);
+        std::vector<uint8_t> vData;
+        while (vData.size() < 5000) {
+            const size_t uLen = (rng() % 4 == 0) ? rng() % 300 : 1 + rng() % 3;
+            vData.insert(vData.end(), uLen, static_cast<uint8_t>(rng() % 4));
+        }
+
+        const auto vEncoded = ByteUtilities::RleEncode(vData);
+        REQUIRE(ByteUtilities::RleDecodedSize(vEncoded) == vData.size());
+
+        std::vector<uint8_t> vDecoded(vData.size());
+        REQUIRE(ByteUtilities::RleDecode(vEncoded, vDecoded));
+        REQUIRE(vDecoded == vData);
+    }
+
+    TEST_CASE("Rle known encoding") {
+        const std::vector<uint8_t> vData = {7, 7, 7, 1, 2, 2};
+        const std::vector<uint8_t> vExpected = {6, 7, 3, 1, 1, 2, 2};
+        REQUIRE(ByteUtilities::RleEncode(vData) == vExpected);
+
+        const std::vector<uint8_t> vLong(200, 9);
+        const std::vector<uint8_t> vLongExpected = {0xC8, 0x01, 9, 0xC8, 0x01};
+        REQUIRE(ByteUtilities::RleEncode(vLong) == vLongExpected);
+
+        REQUIRE(ByteUtilities::RleEncode({}) == std::vector<uint8_t>{0});
+    }
+
+    TEST_CASE("Rle malformed input") {
+        const std::vector<uint8_t> vEncoded = {6, 7, 3, 1, 1, 2, 2};
+        std::vector<uint8_t> vSmall(5);
+        REQUIRE_FALSE(ByteUtilities::RleDecode(vEncoded, vSmall));
+
+        // Runs overflowing the declared size
+        const std::vector<uint8_t> vBad = {2, 7, 3};
+        std::vector<uint8_t> vOut(2);
+        REQUIRE_FALSE(ByteUtilities::RleDecode(vBad, vOut));
+    }
+
+    TEST_CASE("Rle run bitmap") {
+        std::vector<uint8_t> vData(130, 0);
+        vData[40] = 1;
+        vData[64] = 2;
+        vData[65] = 2;
+        vData[129] = 3;
+
+        const auto vBitmap = ByteUtilities::RleRunBitmap(vData);
+        REQUIRE(vBitmap.size() == 3);
+        REQUIRE(vBitmap[0] == ((uint64_t(1) << 0) | (uint64_t(1) << 40) | (uint64_t(1) << 41)));
+        REQUIRE(vBitmap[1] == (uint64_t(1) << 0 | uint64_t(1) << 2));
+        REQUIRE(vBitmap[2] == (uint64_t(1) << 1));
+    }
+}
+
+/**************************************************************************************
+ * Test Section for [Histogram]
+ **************************************************************************************/
+
+TEST_SUITE("[Histogram]") {
+    TEST_CASE_TEMPLATE("Byte histogram", TestType,
+                       std::integral_constant<ByteUtilities::HistogramMethod,
+                                              ByteUtilities::HistogramMethod::InterleavedTables>,
+                       std::integral_constant<ByteUtilities::HistogramMethod,
+                                              ByteUtilities::HistogramMethod::ConflictDetection>) {
+        std::mt19937 rng(53);
+        std::vector<uint8_t> vData(4099);
+        for (auto &uByte : vData) uByte = static_cast<uint8_t>(rng() % 7 == 0 ? 0x41 : rng());
+
+        std::array<uint32_t, 256> aExpected = {};
+        for (const uint8_t uByte : vData) ++aExpected[uByte];
+
+        REQUIRE(ByteUtilities::ByteHistogram<TestType::value>(vData) == aExpected);
+    }
+
+    TEST_CASE("Byte histogram sampling") {
+        // 10 blocks of 256 bytes, block k filled with k
+        std::vector<uint8_t> vData(2560);
+        for (size_t i = 0; i < vData.size(); ++i) vData[i] = static_cast<uint8_t>(i / 256);
+
+        const auto aCounts = ByteUtilities::ByteHistogram(vData, 3);
+        REQUIRE(aCounts[0] == 256);
+        REQUIRE(aCounts[1] == 0);
+        REQUIRE(aCounts[3] == 256);
+        REQUIRE(aCounts[6] == 256);
+        REQUIRE(aCounts[9] == 256);
+        REQUIRE(aCounts[8] == 0);
+    }
+
+    TEST_CASE("Shannon entropy estimate") {
+        const std::vector<uint8_t> vConstant(1000, 3);
+        REQUIRE(ByteUtilities::ShannonEntropyEstimate(vConstant) == doctest::Approx(0.0));
+
+        std::vector<uint8_t> vUniform(256 * 16);
+        for (size_t i = 0; i < vUniform.size(); ++i) vUniform[i] = static_cast<uint8_t>(i);
+        REQUIRE(ByteUtilities::ShannonEntropyEstimate(vUniform) == doctest::Approx(8.0));
+
+        const std::vector<uint8_t> vTwo = {0, 1, 0, 1, 0, 1, 0, 1};
+        REQUIRE(ByteUtilities::ShannonEntropyEstimate(vTwo) == doctest::Approx(1.0));
+
+        REQUIRE(ByteUtilities::ShannonEntropyEstimate({}) == 0.0);
+    }
+}
+
+/**************************************************************************************
+ * Test Section for [Entropy coding]
+ **************************************************************************************/
+
+TEST_SUITE("[Entropy coding]") {
+    TEST_CASE("Fse round trip - bytes") {
+        std::mt19937 rng(54);
+        std::geometric_distribution<int> dist(0.2);
+
+        for (const size_t uSize : {1u, 3u, 4u, 5u, 8u, 9u, 100u, 10'000u}) {
+            std::vector<uint8_t> vData(uSize);
+            for (auto &uByte : vData) uByte = static_cast<uint8_t>(dist(rng) % 256);
+
+            const auto vEncoded = ByteUtilities::FseEncode<uint8_t>(vData);
+            REQUIRE(ByteUtilities::FseDecodedSize(vEncoded) == uSize);
+
+            std::vector<uint8_t> vDecoded(uSize);
+            REQUIRE(ByteUtilities::FseDecode<uint8_t>(vEncoded, vDecoded));
+            REQUIRE(vDecoded == vData);
+
+            if (uSize == 10'000) REQUIRE(vEncoded.size() < uSize / 2);
+        }
+    }
+
+    TEST_CASE("Fse round trip - small integers") {
+        std::mt19937 rng(540);
+        std::vector<uint16_t> vData(5000);
+        for (auto &uValue : vData) uValue = static_cast<uint16_t>((rng() % 8 == 0) ? rng() % 4096 : rng() % 16);
+
+        const auto vEncoded = ByteUtilities::FseEncode<uint16_t>(vData, 12);
+        std::vector<uint16_t> vDecoded(vData.size());
+        REQUIRE(ByteUtilities::FseDecode<uint16_t>(vEncoded, vDecoded));
+        REQUIRE(vDecoded == vData);
+
+        const std::vector<uint16_t> vOutOfRange = {1, 4096};
+        REQUIRE(ByteUtilities::FseEncode<uint16_t>(vOutOfRange).empty());
+    }
+
+    TEST_CASE("Fse round trip - every table log") {
+        std::mt19937 rng(541);
+        std::geometric_distribution<int> dist(0.05);
+        std::vector<uint8_t> vData(20'000);
+        for (auto &uByte : vData) uByte = static_cast<uint8_t>(dist(rng) % 256);
+
+        // The decoder serves the four states of a stream with one 64 bits load up to a table log of 14, pairs
+        // above
+        for (size_t uTableLog = 5; uTableLog <= 15; ++uTableLog) {
+            const auto vEncoded = ByteUtilities::FseEncode<uint8_t>(vData, uTableLog);
+            std::vector<uint8_t> vDecoded(vData.size());
+            REQUIRE(ByteUtilities::FseDecode<uint8_t>(vEncoded, vDecoded));
+            REQUIRE(vDecoded == vData);
+        }
+    }
+
+    TEST_CASE("Fse degenerate input") {
+        const std::vector<uint8_t> vSame(1000, 42);
+        const auto vEncoded = ByteUtilities::FseEncode<uint8_t>(vSame);
+        std::vector<uint8_t> vDecoded(vSame.size());
+        REQUIRE(ByteUtilities::FseDecode<uint8_t>(vEncoded, vDecoded));
+        REQUIRE(vDecoded == vSame);
+
+        const auto vEmpty = ByteUtilities::FseEncode<uint8_t>({});
+        std::vector<uint8_t> vNothing;
+        REQUIRE(ByteUtilities::FseDecode<uint8_t>(vEmpty, vNothing));
+    }
+
+    TEST_CASE("Fse malformed input") {
+        std::vector<uint8_t> vData(300);
+        for (size_t i = 0; i < vData.size(); ++i) vData[i] = static_cast<uint8_t>(i % 5);
+        auto vEncoded = ByteUtilities::FseEncode<uint8_t>(vData);
+
+        std::vector<uint8_t> vWrongSize(299);
+        REQUIRE_FALSE(ByteUtilities::FseDecode<uint8_t>(vEncoded, vWrongSize));
+
+        std::vector<uint8_t> vDecoded(vData.size());
+        auto vTruncated = vEncoded;
+        vTruncated.resize(vTruncated.size() - 9);
+        REQUIRE_FALSE(ByteUtilities::FseDecode<uint8_t>(vTruncated, vDecoded));
+
+        // Flipped stream bits must never read out of bounds and either fail or change the output
+        bool bAllDetected = true;
+        for (size_t i = vEncoded.size() - 40; i < vEncoded.size() - 9; ++i) {
+            auto vCorrupt = vEncoded;
+            vCorrupt[i] ^= 0x10;
+            bAllDetected &= !ByteUtilities::FseDecode<uint8_t>(vCorrupt, vDecoded) || vDecoded != vData;
+        }
+        REQUIRE(bAllDetected);
+    }
+}
+
+/**************************************************************************************
+ * Test Section for [Shuffle filters]
+ **************************************************************************************/
+
+TEST_SUITE("[Shuffle filters]") {
+    TEST_CASE_TEMPLATE("Bit shuffle round trip", TestType, uint8_t, int16_t, uint32_t, uint64_t, float, double) {
+        std::mt19937_64 rng(55);
+        for (const size_t uSize : {0u, 7u, 8u, 40u, 56u, 77u, 1000u}) {
+            std::vector<TestType> vData(uSize);
+            for (auto &value : vData) {
+                const uint64_t uRandom = rng();
+                std::memcpy(&value, &uRandom, sizeof(TestType));
+            }
+
+            std::vector<uint8_t> vShuffled(uSize * sizeof(TestType));
+            ByteUtilities::BitShuffle<TestType>(vData, vShuffled.data());
+
+            std::vector<TestType> vRestored(uSize);
+            ByteUtilities::BitUnshuffle<TestType>(vShuffled.data(), vRestored);
+            if (uSize) REQUIRE(std::memcmp(vRestored.data(), vData.data(), uSize * sizeof(TestType)) == 0);
+        }
+    }
+
+    TEST_CASE("Bit shuffle layout") {
+        std::vector<uint16_t> vData(115);
+        for (size_t i = 0; i < vData.size(); ++i) vData[i] = static_cast<uint16_t>(i * 0x9E37u);
+
+        std::vector<uint8_t> vShuffled(vData.size() * 2);
+        ByteUtilities::BitShuffle<uint16_t>(vData, vShuffled.data());
+
+        // 112 elements go to 16 planes of 14 bytes, the last 3 are copied
+        for (size_t uPlane = 0; uPlane < 16; ++uPlane)
+            for (size_t i = 0; i < 112; ++i)
+                REQUIRE(ByteUtilities::GetBit(vShuffled[uPlane * 14 + i / 8], i % 8) ==
+                        ByteUtilities::GetBit(vData[i], uPlane));
+
+        REQUIRE(std::memcmp(vShuffled.data() + 224, vData.data() + 112, 6) == 0);
+    }
+
+    TEST_CASE_TEMPLATE("Byte shuffle round trip", TestType, uint8_t, int16_t, uint32_t, uint64_t, float, double) {
+        std::mt19937_64 rng(56);
+        for (const size_t uSize : {0u, 1u, 9u, 16u, 33u, 1001u}) {
+            std::vector<TestType> vData(uSize);
+            for (auto &value : vData) {
+                const uint64_t uRandom = rng();
+                std::memcpy(&value, &uRandom, sizeof(TestType));
+            }
+
+            std::vector<uint8_t> vShuffled(uSize * sizeof(TestType));
+            ByteUtilities::ByteShuffle<TestType>(vData, vShuffled.data());
+
+            for (size_t i = 0; i < uSize; ++i) {
+                uint64_t uValue = 0;
+                std::memcpy(&uValue, &vData[i], sizeof(TestType));
+                for (size_t k = 0; k < sizeof(TestType); ++k)
+                    REQUIRE(vShuffled[k * uSize + i] == ByteUtilities::GetByte(uValue, k));
+            }
+
+            std::vector<TestType> vRestored(uSize);
+            ByteUtilities::ByteUnshuffle<TestType>(vShuffled.data(), vRestored);
+            if (uSize) REQUIRE(std::memcmp(vRestored.data(), vData.data(), uSize * sizeof(TestType)) == 0);
+        }
+    }
+}
+
+/**************************************************************************************
+ * Test Section for [Packed samples]
+ **************************************************************************************/
+
+template<size_t _uBits, typename T>
+static void TestSignedRoundTrip(size_t uCount) {
+    std::mt19937 rng(57 + _uBits);
+    const int32_t nMin = -(int32_t(1) << (_uBits - 1));
+    const int32_t nMax = (int32_t(1) << (_uBits - 1)) - 1;
+    std::uniform_int_distribution<int32_t> dist(nMin, nMax);
+
+    std::vector<T> vSamples(uCount);
+    for (auto &nSample : vSamples) nSample = static_cast<T>(dist(rng));
+    if (uCount > 1) {
+        vSamples[0] = static_cast<T>(nMin);
+        vSamples[1] = static_cast<T>(nMax);
+    }
+
+    std::vector<uint8_t> vPacked((uCount * _uBits + 7) / 8);
+    ByteUtilities::PackSigned<_uBits, T>(vSamples, vPacked.data());
+
+    std::vector<T> vUnpacked(uCount);
+    ByteUtilities::UnpackSigned<_uBits, T>(vPacked.data(), vUnpacked);
+    REQUIRE(vUnpacked == vSamples);
+
+    // Bit by bit reference of the LSB first layout
+    std::vector<uint8_t> vExpected(vPacked.size(), 0);
+    for (size_t uBit = 0; uBit < uCount * _uBits; ++uBit)
+        if ((static_cast<uint32_t>(vSamples[uBit / _uBits]) >> (uBit % _uBits)) & 1u)
+            vExpected[uBit / 8] |= static_cast<uint8_t>(1u << (uBit % 8));
+    REQUIRE(vPacked == vExpected);
+}
+
+TEST_SUITE("[Packed samples]") {
+    TEST_CASE("Signed samples round trip") {
+        for (const size_t uCount : {0u, 1u, 15u, 16u, 17u, 100u, 1000u}) {
+            TestSignedRoundTrip<10, int16_t>(uCount);
+            TestSignedRoundTrip<12, int16_t>(uCount);
+            TestSignedRoundTrip<14, int16_t>(uCount);
+            TestSignedRoundTrip<16, int16_t>(uCount);
+            TestSignedRoundTrip<12, int32_t>(uCount);
+            TestSignedRoundTrip<20, int32_t>(uCount);
+            TestSignedRoundTrip<22, int32_t>(uCount);
+            TestSignedRoundTrip<24, int32_t>(uCount);
+            TestSignedRoundTrip<7, int32_t>(uCount);
+        }
+    }
+
+    TEST_CASE("Signed 12 bits layout") {
+        // 0xFFF (-1) then 0x801 (-2047): bytes 0xFF, 0x1F, 0x80
+        const std::vector<uint8_t> vPacked = {0xFF, 0x1F, 0x80};
+        std::vector<int16_t> vSamples(2);
+        ByteUtilities::UnpackSigned<12, int16_t>(vPacked.data(), vSamples);
+        REQUIRE(vSamples[0] == -1);
+        REQUIRE(vSamples[1] == -2047);
+    }
+}
+
+/**************************************************************************************
+ * Test Section for [Bitmap conversion]
+ **************************************************************************************/
+
+TEST_SUITE("[Bitmap conversion]") {
+    TEST_CASE("Pack bools") {
+        std::mt19937 rng(58);
+        for (const size_t uSize : {0u, 1u, 63u, 64u, 65u, 200u, 1000u}) {
+            std::vector<uint8_t> vBools(uSize);
+            for (auto &uBool : vBools) uBool = (rng() % 3 == 0) ? static_cast<uint8_t>(1 + rng() % 255) : 0;
+
+            std::vector<uint64_t> vExpected((uSize + 63) / 64, 0);
+            for (size_t i = 0; i < uSize; ++i) ByteUtilities::SetBit(vExpected[i / 64], i % 64, vBools[i] != 0);
+
+            std::vector<uint64_t> vBitmap((uSize + 63) / 64, ~uint64_t(0));
+            ByteUtilities::PackBools(vBools, vBitmap.data());
+            REQUIRE(vBitmap == vExpected);
+        }
+    }
+
+    TEST_CASE("Unpack bits") {
+        std::mt19937_64 rng(580);
+        for (const size_t uSize : {0u, 5u, 32u, 64u, 100u, 1000u}) {
+            std::vector<uint64_t> vBitmap((uSize + 63) / 64);
+            for (auto &uWord : vBitmap) uWord = rng();
+
+            std::vector<uint8_t> vBools(uSize);
+            std::vector<uint8_t> vMasks(uSize);
+            ByteUtilities::UnpackBits(vBitmap.data(), vBools);
+            ByteUtilities::UnpackBitsToMask(vBitmap.data(), vMasks);
+
+            for (size_t i = 0; i < uSize; ++i) {
+                const bool bBit = ByteUtilities::GetBit(vBitmap[i / 64], i % 64);
+                REQUIRE(vBools[i] == (bBit ? 0x01 : 0x00));
+                REQUIRE(vMasks[i] == (bBit ? 0xFF : 0x00));
+            }
+
+            // Round trip, ignoring the bits past uSize
+            std::vector<uint64_t> vPacked(vBitmap.size());
+            ByteUtilities::PackBools(vBools, vPacked.data());
+            for (size_t w = 0; w < vPacked.size(); ++w) {
+                const size_t uBits = (uSize - w * 64) < 64 ? (uSize - w * 64) : 64;
+                const uint64_t uMask = uBits == 64 ? ~uint64_t(0) : ByteUtilities::CreateBitMask<uint64_t>(0, uBits);
+                REQUIRE(vPacked[w] == (vBitmap[w] & uMask));
+            }
+        }
+    }
+}
+
+/**************************************************************************************
+ * Test Section for [Predicate evaluation]
+ **************************************************************************************/
+
+template<ByteUtilities::CompareOp _eOp, typename T, typename Fn>
+static void TestCompareToBitmap(const std::vector<T> &vData, T value, Fn fnExpected) {
+    std::vector<uint64_t> vBitmap((vData.size() + 63) / 64, ~uint64_t(0));
+    ByteUtilities::CompareToBitmap<_eOp, T>(vData, value, vBitmap.data());
+
+    for (size_t i = 0; i < vData.size(); ++i)
+        REQUIRE(ByteUtilities::GetBit(vBitmap[i / 64], i % 64) == fnExpected(vData[i], value));
+    if (vData.size() % 64) REQUIRE((vBitmap.back() >> (vData.size() % 64)) == 0);
+}
+
+TEST_SUITE("[Predicate evaluation]") {
+    TEST_CASE_TEMPLATE("Compare to bitmap", TestType, int8_t, uint8_t, int16_t, uint16_t, int32_t, uint32_t,
+                       int64_t, uint64_t, float, double) {
+        using CompareOp = ByteUtilities::CompareOp;
+
+        std::mt19937_64 rng(59);
+        std::vector<TestType> vData(300);
+        for (auto &value : vData) {
+            // Values around zero and around the extremes of the type
+            const uint64_t uRandom = rng();
+            constexpr TestType MAX = std::numeric_limits<TestType>::max();
+            if (uRandom % 2) value = static_cast<TestType>(static_cast<int>(uRandom % 9) - 4);
+            else value = static_cast<TestType>(MAX - static_cast<TestType>(uRandom % 3));
+        }
+        if constexpr (std::is_floating_point<TestType>::value) vData[10] = std::numeric_limits<TestType>::quiet_NaN();
+
+        for (const TestType value : {TestType(0), TestType(2), std::numeric_limits<TestType>::max()}) {
+            TestCompareToBitmap<CompareOp::Equal>(vData, value, [](TestType a, TestType b) { return a == b; });
+            TestCompareToBitmap<CompareOp::NotEqual>(vData, value, [](TestType a, TestType b) { return a != b; });
+            TestCompareToBitmap<CompareOp::Less>(vData, value, [](TestType a, TestType b) { return a < b; });
+            TestCompareToBitmap<CompareOp::LessEqual>(vData, value, [](TestType a, TestType b) { return a <= b; });
+            TestCompareToBitmap<CompareOp::Greater>(vData, value, [](TestType a, TestType b) { return a > b; });
+            TestCompareToBitmap<CompareOp::GreaterEqual>(vData, value, [](TestType a, TestType b) { return a >= b; });
+        }
+    }
+
+    TEST_CASE("Range, set and conjunction") {
+        std::vector<int32_t> vData(200);
+        for (size_t i = 0; i < vData.size(); ++i) vData[i] = static_cast<int32_t>(i % 50) - 10;
+
+        std::vector<uint64_t> vRange(4);
+        ByteUtilities::RangeToBitmap<int32_t>(vData, -2, 3, vRange.data());
+
+        const std::vector<int32_t> vSet = {-10, 0, 7, 1000};
+        std::vector<uint64_t> vInSet(4);
+        ByteUtilities::InSetToBitmap<int32_t>(vData, vSet, vInSet.data());
+
+        // -2 <= x < 3 AND x IN set, evaluated in place
+        std::vector<uint64_t> vBoth = vRange;
+        ByteUtilities::InSetToBitmap<int32_t>(vData, vSet, vBoth.data(), ByteUtilities::BitmapMerge::And);
+
+        for (size_t i = 0; i < vData.size(); ++i) {
+            const int32_t nValue = vData[i];
+            const bool bInRange = -2 <= nValue && nValue < 3;
+            const bool bInSet = nValue == -10 || nValue == 0 || nValue == 7;
+            REQUIRE(ByteUtilities::GetBit(vRange[i / 64], i % 64) == bInRange);
+            REQUIRE(ByteUtilities::GetBit(vInSet[i / 64], i % 64) == bInSet);
+            REQUIRE(ByteUtilities::GetBit(vBoth[i / 64], i % 64) == (bInRange && bInSet));
+        }
+        REQUIRE((vBoth[3] >> 8) == 0);
+    }
+
+    TEST_CASE("Large inputs are split over the pool") {
+        // Above the 1 MiB cut-off, with a partial last word
+        std::mt19937 rng(5959);
+        std::vector<int32_t> vData(300001);
+        for (int32_t &nValue : vData) nValue = static_cast<int32_t>(rng() % 1000);
+
+        std::vector<uint64_t> vLess((vData.size() + 63) / 64, ~uint64_t(0));
+        ByteUtilities::CompareToBitmap<ByteUtilities::CompareOp::Less, int32_t>(vData, 500, vLess.data());
+        std::vector<uint64_t> vBoth = vLess;
+        ByteUtilities::RangeToBitmap<int32_t>(vData, 100, 900, vBoth.data(), ByteUtilities::BitmapMerge::And);
+
+        bool bMatch = true;
+        for (size_t i = 0; i < vData.size(); ++i) {
+            bMatch = bMatch && ByteUtilities::GetBit(vLess[i / 64], i % 64) == (vData[i] < 500);
+            bMatch = bMatch && ByteUtilities::GetBit(vBoth[i / 64], i % 64) == (vData[i] >= 100 && vData[i] < 500);
+        }
+        REQUIRE(bMatch);
+        REQUIRE((vLess.back() >> (vData.size() % 64)) == 0);
+    }
+}
+
+/**************************************************************************************
+ * Test Section for [Rank]
+ **************************************************************************************/
+
+TEST_SUITE("[Rank]") {
+    TEST_CASE("Prefix popcount") {
+        std::mt19937_64 rng(60);
+        for (const size_t uSize : {0u, 1u, 7u, 1000u, 300'000u}) {
+            std::vector<uint64_t> vBitmap(uSize);
+            for (auto &uWord : vBitmap) uWord = rng() & rng();
+
+            std::vector<uint64_t> vExpected(uSize);
+            uint64_t uRunning = 0;
+            for (size_t i = 0; i < uSize; ++i) {
+                vExpected[i] = uRunning;
+                for (size_t b = 0; b < 64; ++b) uRunning += ByteUtilities::GetBit(vBitmap[i], b);
+            }
+
+            for (const size_t uThreads : {1u, 3u, 8u}) {
+                std::vector<uint64_t> vOffsets(uSize, 12345);
+                REQUIRE(ByteUtilities::PrefixPopCount(vBitmap, vOffsets.data(), uThreads) == uRunning);
+                REQUIRE(vOffsets == vExpected);
+            }
+        }
+    }
+}
+
+/**************************************************************************************
+ * Test Section for [Pattern matching]
+ **************************************************************************************/
+
+static std::vector<size_t> NaiveHammingMatches(std::string_view text, std::string_view pattern, size_t uMax) {
+    std::vector<size_t> vMatches;
+    for (size_t i = 0; i + pattern.size() <= text.size(); ++i) {
+        size_t uMismatches = 0;
+        for (size_t j = 0; j < pattern.size(); ++j) uMismatches += text[i + j] != pattern[j];
+        if (uMismatches <= uMax) vMatches.push_back(i);
+    }
+    return vMatches;
+}
+
+TEST_SUITE("[Pattern matching]") {
+    TEST_CASE("Bitap exact match") {
+        const ByteUtilities::BitapMatcher matcher("abra");
+        REQUIRE(matcher.Find("abracadabra") == 0);
+        REQUIRE(matcher.Find("abracadabra", 1) == 7);
+        REQUIRE(matcher.Find("abracadabr", 1) == std::string_view::npos);
+        REQUIRE(ByteUtilities::BitapMatcher("").Find("abc") == std::string_view::npos);
+
+        std::vector<size_t> vMatches;
+        ByteUtilities::BitapMatcher("aa").FindAll("aaaa", [&](size_t uPos) { vMatches.push_back(uPos); });
+        REQUIRE(vMatches == std::vector<size_t>{0, 1, 2});
+    }
+
+    TEST_CASE("Bitap long patterns and mismatches") {
+        std::mt19937 rng(61);
+        std::string sText(5000, 'a');
+        for (auto &cChar : sText) cChar = static_cast<char>('a' + rng() % 3);
+
+        for (const size_t uLength : {1u, 5u, 64u, 65u, 130u}) {
+            for (const size_t uMax : {0u, 1u, 3u}) {
+                // Pattern taken from the text with a couple of changes
+                std::string sPattern = sText.substr(1234, uLength);
+                sPattern[uLength / 2] = 'z';
+                if (uLength > 4) sPattern[1] = 'y';
+
+                std::vector<size_t> vMatches;
+                const ByteUtilities::BitapMatcher matcher(sPattern, uMax);
+                matcher.FindAll(sText, [&](size_t uPos) { vMatches.push_back(uPos); });
+                REQUIRE(vMatches == NaiveHammingMatches(sText, sPattern, uMax));
+
+                const size_t uFirst = vMatches.empty() ? std::string_view::npos : vMatches.front();
+                REQUIRE(matcher.Find(sText) == uFirst);
+            }
+        }
+    }
+
+    TEST_CASE("Bitap multiple patterns") {
+        const ByteUtilities::BitapMultiMatcher matcher({"GET", "", "POST", "T /"});
+
+        std::vector<std::pair<size_t, size_t>> vMatches;
+        matcher.FindAll("GET /a POST /b", [&](size_t uPattern, size_t uPos) { vMatches.emplace_back(uPattern, uPos); });
+
+        const std::vector<std::pair<size_t, size_t>> vExpected = {{0, 0}, {3, 2}, {2, 7}, {3, 10}};
+        REQUIRE(vMatches == vExpected);
+        REQUIRE(std::vector<size_t>(matcher.Packed().begin(), matcher.Packed().end()) == std::vector<size_t>{0, 2, 3});
+    }
+
+    TEST_CASE("Bitap multiple patterns past 256") {
+        // Only the patterns that fit are packed, their indexes are reported in full
+        std::vector<std::string> vNames(300);
+        for (size_t p = 0; p < vNames.size(); ++p) vNames[p] = p % 100 == 99 ? "x" + std::to_string(p) : "";
+        vNames.push_back(std::string(61, 'y'));
+        vNames.push_back("zz");
+
+        const std::vector<std::string_view> vPatterns(vNames.begin(), vNames.end());
+        const ByteUtilities::BitapMultiMatcher matcher(vPatterns);
+        REQUIRE(std::vector<size_t>(matcher.Packed().begin(), matcher.Packed().end()) ==
+                std::vector<size_t>{99, 199, 299, 301});
+
+        std::vector<std::pair<size_t, size_t>> vMatches;
+        matcher.FindAll("a x299 zz", [&](size_t uPattern, size_t uPos) { vMatches.emplace_back(uPattern, uPos); });
+
+        const std::vector<std::pair<size_t, size_t>> vExpected = {{299, 2}, {301, 7}};
+        REQUIRE(vMatches == vExpected);
+    }
+}
+
+/**************************************************************************************
+ * Test Section for [Edit distance]
+ **************************************************************************************/
+
+TEST_SUITE("[Edit distance]") {
+    TEST_CASE("Myers edit distance") {
+        REQUIRE(ByteUtilities::EditDistance("kitten", "sitting") == 3);
+        REQUIRE(ByteUtilities::EditDistance("", "abc") == 3);
+        REQUIRE(ByteUtilities::EditDistance("abc", "") == 3);
+        REQUIRE(ByteUtilities::EditDistance("flaw", "lawn") == 2);
+
+        const auto Reference = [](std::string_view a, std::string_view b) {
+            std::vector<size_t> vRow(b.size() + 1);
+            for (size_t j = 0; j <= b.size(); ++j) vRow[j] = j;
+            for (size_t i = 1; i <= a.size(); ++i) {
+                size_t uDiagonal = vRow[0];
+                vRow[0] = i;
+                for (size_t j = 1; j <= b.size(); ++j) {
+                    const size_t uUp = vRow[j];
+                    vRow[j] = std::min({uUp + 1, vRow[j - 1] + 1, uDiagonal + (a[i - 1] != b[j - 1])});
+                    uDiagonal = uUp;
+                }
+            }
+            return vRow[b.size()];
+        };
+
+        std::mt19937 rng(62);
+        const auto RandomString = [&](size_t uLength) {
+            std::string sValue(uLength, 'a');
+            for (auto &cChar : sValue) cChar = static_cast<char>('a' + rng() % 4);
+            return sValue;
+        };
+
+        for (const size_t uLength : {1u, 30u, 64u, 65u, 150u}) {
+            const std::string sPattern = RandomString(uLength);
+            const ByteUtilities::MyersPattern pattern(sPattern);
+
+            std::vector<std::string> vCandidates;
+            for (size_t k = 0; k < 20; ++k) {
+                vCandidates.push_back(RandomString(uLength + rng() % 20 - (uLength > 10 ? 10 : 0)));
+            }
+            const std::vector<std::string_view> vViews(vCandidates.begin(), vCandidates.end());
+
+            std::vector<size_t> vDistances(vViews.size());
+            pattern.Distances(vViews, vDistances.data());
+
+            std::vector<size_t> vBounded(vViews.size());
+            const size_t uMax = uLength / 3;
+            pattern.Distances(vViews, vBounded.data(), uMax);
+
+            for (size_t k = 0; k < vViews.size(); ++k) {
+                const size_t uExpected = Reference(sPattern, vViews[k]);
+                REQUIRE(vDistances[k] == uExpected);
+                REQUIRE(pattern.Distance(vViews[k]) == uExpected);
+                REQUIRE(vBounded[k] == (uExpected > uMax ? uMax + 1 : uExpected));
+            }
+        }
+    }
+}
+
+/**************************************************************************************
+ * Test Section for [Bit set]
+ **************************************************************************************/
+
+TEST_SUITE("[Bit set]") {
+    TEST_CASE("BitSet constexpr operations") {
+        constexpr auto set = [] {
+            ByteUtilities::BitSet<130> result;
+            result.Set(3);
+            result.Set(64);
+            result.Set(129);
+            result.Flip(70);
+            result.Reset(3);
+            return result;
+        }();
+        static_assert(set.PopCount() == 3);
+        static_assert(set.FindFirst() == 64);
+        static_assert(set.FindNext(64) == 70);
+        static_assert(set.FindNext(70) == 129);
+        static_assert(set.FindNext(129) == set.npos);
+        static_assert(set.Slice<60, 12>() == 0x410);
+        static_assert(set.Slice<66, 64>() == (uint64_t(1) << 63 | uint64_t(1) << 4));
+        static_assert((~set).PopCount() == 127);
+        static_assert((set ^ set).None());
+        static_assert(ByteUtilities::GetBitSlice(0x37AB, 9, 5) == 0x001B);
+
+        REQUIRE(set.Test(70));
+        REQUIRE_FALSE(set.Test(3));
+    }
+
+    TEST_CASE("BitSet bulk operations against std::bitset") {
+        std::mt19937_64 rng(63);
+        ByteUtilities::BitSet<1000> a, b;
+        std::bitset<1000> refA, refB;
+        for (size_t i = 0; i < 1000; ++i) {
+            const uint64_t uValue = rng();
+            a.Set(i, uValue & 1u);
+            refA[i] = uValue & 1u;
+            b.Set(i, uValue & 2u);
+            refB[i] = uValue & 2u;
+        }
+
+        const auto Matches = [](const ByteUtilities::BitSet<1000> &set, const std::bitset<1000> &ref) {
+            if (set.PopCount() != ref.count()) return false;
+            for (size_t i = 0; i < 1000; ++i)
+                if (set.Test(i) != ref[i]) return false;
+            return true;
+        };
+        REQUIRE(Matches(a & b, refA & refB));
+        REQUIRE(Matches(a | b, refA | refB));
+        REQUIRE(Matches(a ^ b, refA ^ refB));
+        REQUIRE(Matches(~a, ~refA));
+
+        size_t uVisited = 0;
+        for (size_t i = a.FindFirst(); i != a.npos; i = a.FindNext(i)) {
+            REQUIRE(refA[i]);
+            ++uVisited;
+        }
+        REQUIRE(uVisited == refA.count());
+
+        ByteUtilities::BitSet<1000> full;
+        full.Fill();
+        REQUIRE(full.PopCount() == 1000);
+        REQUIRE(full == ~ByteUtilities::BitSet<1000>());
+    }
+
+    TEST_CASE("BitSet as hash key") {
+        std::unordered_set<ByteUtilities::BitSet<100>> sets;
+        for (size_t i = 0; i < 100; ++i) {
+            ByteUtilities::BitSet<100> set;
+            set.Set(i);
+            sets.insert(set);
+            sets.insert(set);
+        }
+        REQUIRE(sets.size() == 100);
+
+        ByteUtilities::BitSet<100> probe;
+        probe.Set(42);
+        REQUIRE(sets.count(probe) == 1);
+        REQUIRE(probe.Hash() != ByteUtilities::BitSet<100>().Hash());
+    }
+}
+
+/**************************************************************************************
+ * Test Section for [Dynamic bit set]
+ **************************************************************************************/
+
+/**
+ * @brief Allocator counting its allocations, to check the inline storage and the moves of
+ * ByteUtilities::DynamicBitset.
+ *
+ */
+template<typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    explicit CountingAllocator(size_t *pCount) noexcept : pAllocations(pCount) {}
+
+    template<typename U>
+    CountingAllocator(const CountingAllocator<U> &other) noexcept : pAllocations(other.pAllocations) {}
+
+    T *allocate(size_t uSize) {
+        ++*pAllocations;
+        return std::allocator<T>().allocate(uSize);
+    }
+
+    void deallocate(T *pData, size_t uSize) noexcept {
+        std::allocator<T>().deallocate(pData, uSize);
+    }
+
+    template<typename U>
+    bool operator==(const CountingAllocator<U> &other) const noexcept {
+        return pAllocations == other.pAllocations;
+    }
+
+    size_t *pAllocations;
+};
+
+TEST_SUITE("[Dynamic bit set]") {
+    TEST_CASE("DynamicBitset inline storage and growth") {
+        size_t uAllocations = 0;
+        using Bitset = ByteUtilities::DynamicBitset<2, CountingAllocator<uint64_t>>;
+        Bitset set{CountingAllocator<uint64_t>(&uAllocations)};
+
+        std::vector<bool> vReference;
+        std::mt19937 rng(64);
+        for (size_t i = 0; i < 128; ++i) {
+            const bool bValue = rng() & 1u;
+            set.PushBack(bValue);
+            vReference.push_back(bValue);
+        }
+        REQUIRE(set.IsInline());
+        REQUIRE(uAllocations == 0);
+
+        for (size_t i = 128; i < 5000; ++i) {
+            const bool bValue = rng() % 3 == 0;
+            set.PushBack(bValue);
+            vReference.push_back(bValue);
+        }
+        REQUIRE_FALSE(set.IsInline());
+        REQUIRE(uAllocations <= 8);
+        REQUIRE(set.Size() == vReference.size());
+        for (size_t i = 0; i < vReference.size(); ++i) REQUIRE(set.Test(i) == vReference[i]);
+        REQUIRE(set.PopCount() == size_t(std::count(vReference.begin(), vReference.end(), true)));
+
+        size_t uVisited = 0;
+        for (size_t i = set.FindFirst(); i != set.npos; i = set.FindNext(i)) {
+            REQUIRE(vReference[i]);
+            ++uVisited;
+        }
+        REQUIRE(uVisited == set.PopCount());
+
+        set.Resize(70);
+        set.Resize(200, true);
+        REQUIRE(set.Test(69) == vReference[69]);
+        for (size_t i = 70; i < 200; ++i) REQUIRE(set.Test(i));
+        set.Resize(130);
+        REQUIRE(set.PopCount() == size_t(std::count(vReference.begin(), vReference.begin() + 70, true)) + 60);
+    }
+
+    TEST_CASE("DynamicBitset moves do not copy") {
+        size_t uAllocations = 0;
+        using Bitset = ByteUtilities::DynamicBitset<1, CountingAllocator<uint64_t>>;
+        Bitset set(1000, true, CountingAllocator<uint64_t>(&uAllocations));
+        REQUIRE(uAllocations == 1);
+
+        const uint64_t *pData = set.Data();
+        Bitset moved(std::move(set));
+        REQUIRE(moved.Data() == pData);
+        REQUIRE(set.Size() == 0);
+
+        Bitset assigned{CountingAllocator<uint64_t>(&uAllocations)};
+        assigned = std::move(moved);
+        REQUIRE(assigned.Data() == pData);
+        REQUIRE(assigned.PopCount() == 1000);
+        REQUIRE(uAllocations == 1);
+
+        Bitset copy(assigned);
+        REQUIRE(uAllocations == 2);
+        REQUIRE(copy == assigned);
+
+        Bitset small(40, true, CountingAllocator<uint64_t>(&uAllocations));
+        Bitset smallMoved(std::move(small));
+        REQUIRE(smallMoved.IsInline());
+        REQUIRE(smallMoved.PopCount() == 40);
+        REQUIRE(uAllocations == 2);
+    }
+
+    TEST_CASE("DynamicBitset bulk operations") {
+        ByteUtilities::DynamicBitset<> a(777), b(777);
+        for (size_t i = 0; i < 777; i += 3) a.Set(i);
+        for (size_t i = 0; i < 777; i += 5) b.Set(i);
+
+        REQUIRE((a & b).PopCount() == (776 / 15 + 1));
+        REQUIRE((a | b).PopCount() == (776 / 3 + 1) + (776 / 5 + 1) - (776 / 15 + 1));
+        REQUIRE((a ^ b).PopCount() == (a | b).PopCount() - (a & b).PopCount());
+        REQUIRE((~a).PopCount() == 777 - a.PopCount());
+
+        ByteUtilities::DynamicBitset<> c(a);
+        c.AndNot(b);
+        REQUIRE(c.PopCount() == a.PopCount() - (a & b).PopCount());
+
+        std::unordered_set<ByteUtilities::DynamicBitset<>> sets = {a, b, a};
+        REQUIRE(sets.size() == 2);
+    }
+
+    TEST_CASE("Large bulk operations are split over the pool") {
+        constexpr size_t uBits = (size_t(1u) << 24) + 37;
+        std::mt19937_64 rng(6464);
+        ByteUtilities::DynamicBitset<> lhs(uBits), rhs(uBits);
+        for (size_t i = 0; i < uBits; i += 1 + rng() % 5) lhs.Set(i);
+        for (size_t i = 0; i < uBits; i += 1 + rng() % 3) rhs.Set(i);
+
+        const auto Expect = [&](const ByteUtilities::DynamicBitset<> &result, auto fnOp) {
+            bool bMatch = true;
+            size_t uCount = 0;
+            for (size_t w = 0; w < result.WordCount(); ++w) {
+                bMatch = bMatch && result.Word(w) == fnOp(lhs.Word(w), rhs.Word(w));
+                uCount += std::popcount(result.Word(w));
+            }
+            return bMatch && result.PopCount() == uCount;
+        };
+        REQUIRE(Expect(lhs & rhs, [](uint64_t a, uint64_t b) { return a & b; }));
+        REQUIRE(Expect(lhs | rhs, [](uint64_t a, uint64_t b) { return a | b; }));
+        REQUIRE(Expect(lhs ^ rhs, [](uint64_t a, uint64_t b) { return a ^ b; }));
+        ByteUtilities::DynamicBitset<> difference = lhs;
+        difference.AndNot(rhs);
+        REQUIRE(Expect(difference, [](uint64_t a, uint64_t b) { return a & ~b; }));
+    }
+}
+
+/**************************************************************************************
+ * Test Section for [Memory resources]
+ **************************************************************************************/
+
+TEST_SUITE("[Memory resources]") {
+    TEST_CASE("Monotonic arena") {
+        ByteUtilities::MonotonicArena arena(4096);
+        std::vector<void *> vBlocks;
+        for (size_t i = 1; i <= 200; ++i) {
+            const size_t uAlignment = size_t(1u) << (i % 8);
+            void *pBlock = arena.allocate(i * 7, uAlignment);
+            REQUIRE(reinterpret_cast<uintptr_t>(pBlock) % uAlignment == 0);
+            std::memset(pBlock, int(i), i * 7);
+            vBlocks.push_back(pBlock);
+        }
+        for (size_t i = 1; i <= 200; ++i) REQUIRE(static_cast<uint8_t *>(vBlocks[i - 1])[i * 7 - 1] == uint8_t(i));
+        REQUIRE(arena.Allocated() == 7 * 200 * 201 / 2);
+
+        // The largest chunk is kept and reused after a reset
+        const size_t uReserved = arena.Reserved();
+        arena.Reset();
+        REQUIRE(arena.Allocated() == 0);
+        REQUIRE(arena.Reserved() <= uReserved);
+        const size_t uKept = arena.Reserved();
+        REQUIRE(arena.allocate(uKept / 2, 64) != nullptr);
+        REQUIRE(arena.Reserved() == uKept);
+
+        // Blocks bigger than a chunk get their own chunk
+        void *pLarge = arena.allocate(size_t(1u) << 20, 4096);
+        REQUIRE(reinterpret_cast<uintptr_t>(pLarge) % 4096 == 0);
+        arena.Release();
+        REQUIRE(arena.Reserved() == 0);
+
+        // Sizes whose chunk size would wrap around are refused, not served from a tiny chunk
+        constexpr size_t MAX = std::numeric_limits<size_t>::max();
+        REQUIRE_THROWS_AS(static_cast<void>(arena.allocate(MAX - 8, 64)), std::bad_alloc);
+        REQUIRE_THROWS_AS(static_cast<void>(arena.allocate(MAX - 100, 64)), std::bad_alloc);
+        REQUIRE(arena.Reserved() == 0);
+        REQUIRE(arena.allocate(100, 64) != nullptr);
+        REQUIRE_THROWS_AS(static_cast<void>(arena.allocate(MAX - 8, 8)), std::bad_alloc);
+    }
+
+    TEST_CASE("Huge page aligned arena") {
+        ByteUtilities::MonotonicArena arena(ByteUtilities::HUGE_PAGE_SIZE, ByteUtilities::HUGE_PAGE_SIZE);
+        void *pBlock = arena.allocate(100, 64);
+        REQUIRE(reinterpret_cast<uintptr_t>(pBlock) % ByteUtilities::HUGE_PAGE_SIZE == 0);
+        REQUIRE(arena.Reserved() == ByteUtilities::HUGE_PAGE_SIZE);
+    }
+
+    TEST_CASE("Size class pool") {
+        ByteUtilities::PoolResource pool;
+        void *pA = pool.allocate(100, 8);
+        void *pB = pool.allocate(100, 8);
+        REQUIRE(pA != pB);
+        REQUIRE(reinterpret_cast<uintptr_t>(pA) % 128 == 0);
+        pool.deallocate(pA, 100, 8);
+        REQUIRE(pool.allocate(120, 8) == pA);
+
+        void *pPage = pool.allocate(10, 4096);
+        REQUIRE(reinterpret_cast<uintptr_t>(pPage) % 4096 == 0);
+
+        void *pLarge = pool.allocate(size_t(1u) << 20, 64);
+        std::memset(pLarge, 0, size_t(1u) << 20);
+        pool.deallocate(pLarge, size_t(1u) << 20, 64);
+        pool.Reset();
+    }
+
+    TEST_CASE("Codecs and containers on memory resources") {
+        std::vector<uint8_t> vOld(5000), vNew;
+        std::mt19937 rng(65);
+        for (auto &uByte : vOld) uByte = static_cast<uint8_t>(rng() % 4);
+        vNew = vOld;
+        vNew[100] ^= 1;
+        vNew[4000] ^= 2;
+
+        ByteUtilities::MonotonicArena arena;
+        std::pmr::polymorphic_allocator<uint8_t> allocator(&arena);
+
+        const auto vPatch = ByteUtilities::XorDelta(vOld, vNew, allocator);
+        const auto vExpectedPatch = ByteUtilities::XorDelta(vOld, vNew);
+        REQUIRE(std::equal(vPatch.begin(), vPatch.end(), vExpectedPatch.begin(), vExpectedPatch.end()));
+        const auto vRle = ByteUtilities::RleEncode(vOld, allocator);
+        REQUIRE(vRle.get_allocator().resource() == &arena);
+        const auto vBitmap = ByteUtilities::RleRunBitmap(vOld, std::pmr::polymorphic_allocator<uint64_t>(&arena));
+        const auto vExpectedBitmap = ByteUtilities::RleRunBitmap(vOld);
+        REQUIRE(std::equal(vBitmap.begin(), vBitmap.end(), vExpectedBitmap.begin(), vExpectedBitmap.end()));
+        const auto vFse = ByteUtilities::FseEncode<uint8_t>(vOld, 11, allocator);
+        std::vector<uint8_t> vDecoded(vOld.size());
+        REQUIRE(ByteUtilities::FseDecode<uint8_t>(vFse, vDecoded));
+        REQUIRE(vDecoded == vOld);
+        REQUIRE(arena.Allocated() > 0);
+
+        ByteUtilities::PoolResource pool;
+        using Bitset = ByteUtilities::DynamicBitset<1, std::pmr::polymorphic_allocator<uint64_t>>;
+        Bitset set(1000, true, std::pmr::polymorphic_allocator<uint64_t>(&pool));
+        Bitset other(std::move(set));
+        REQUIRE(other.PopCount() == 1000);
+        REQUIRE(other.GetAllocator().resource() == &pool);
+    }
+}
+
+/**************************************************************************************
+ * Test Section for [Hierarchical bitmap]
+ **************************************************************************************/
+
+TEST_SUITE("[Hierarchical bitmap]") {
+    TEST_CASE("Hierarchical bitmap against a flat reference") {
+        std::mt19937_64 rng(66);
+        for (const size_t uSize : {1u, 64u, 100u, 4096u, 4097u, 300'000u}) {
+            ByteUtilities::HierarchicalBitmap bitmap(uSize);
+            std::vector<bool> vReference(uSize, false);
+            REQUIRE(bitmap.FindNextSet(0) == bitmap.npos);
+            REQUIRE(bitmap.FindFirstZero() == 0);
+
+            const auto NextSet = [&](size_t uPos) {
+                for (; uPos < uSize; ++uPos)
+                    if (vReference[uPos]) return uPos;
+                return bitmap.npos;
+            };
+            const auto FirstZero = [&]() {
+                for (size_t uPos = 0; uPos < uSize; ++uPos)
+                    if (!vReference[uPos]) return uPos;
+                return bitmap.npos;
+            };
+
+            // Sparse phase, then dense phase filling a prefix
+            for (size_t uStep = 0; uStep < 2000; ++uStep) {
+                const size_t uPos = rng() % uSize;
+                if (rng() % 3) {
+                    bitmap.SetBit(uPos);
+                    vReference[uPos] = true;
+                } else {
+                    bitmap.ClearBit(uPos);
+                    vReference[uPos] = false;
+                }
+                const size_t uProbe = rng() % uSize;
+                REQUIRE(bitmap.FindNextSet(uProbe) == NextSet(uProbe));
+                REQUIRE(bitmap.Test(uProbe) == vReference[uProbe]);
+            }
+            const size_t uPrefix = std::min<size_t>(uSize, 5000);
+            for (size_t uPos = 0; uPos < uPrefix; ++uPos) {
+                bitmap.SetBit(uPos);
+                vReference[uPos] = true;
+            }
+            REQUIRE(bitmap.FindFirstZero() == FirstZero());
+            for (size_t uStep = 0; uStep < 200; ++uStep) {
+                const size_t uPos = rng() % uPrefix;
+                bitmap.ClearBit(uPos);
+                vReference[uPos] = false;
+                REQUIRE(bitmap.FindFirstZero() == FirstZero());
+                bitmap.SetBit(uPos);
+                vReference[uPos] = true;
+            }
+
+            size_t uCount = 0;
+            for (size_t uPos = bitmap.FindNextSet(0); uPos != bitmap.npos; uPos = bitmap.FindNextSet(uPos + 1))
+                ++uCount;
+            REQUIRE(uCount == size_t(std::count(vReference.begin(), vReference.end(), true)));
+        }
+    }
+
+    TEST_CASE("Hierarchical bitmap full and empty") {
+        ByteUtilities::HierarchicalBitmap bitmap(64 * 64 + 64);
+        for (size_t uPos = 0; uPos < bitmap.Size(); ++uPos) bitmap.SetBit(uPos);
+        REQUIRE(bitmap.FindFirstZero() == bitmap.npos);
+        bitmap.ClearBit(4100);
+        REQUIRE(bitmap.FindFirstZero() == 4100);
+        for (size_t uPos = 0; uPos < bitmap.Size(); ++uPos) bitmap.ClearBit(uPos);
+        REQUIRE(bitmap.FindNextSet(0) == bitmap.npos);
+        bitmap.SetBit(bitmap.Size() - 1);
+        REQUIRE(bitmap.FindNextSet(0) == bitmap.Size() - 1);
+        REQUIRE(bitmap.FindNextSet(bitmap.Size()) == bitmap.npos);
+    }
+}
+
+/**************************************************************************************
+ * Test Section for [Priority queue]
+ **************************************************************************************/
+
+TEST_SUITE("[Priority queue]") {
+    TEST_CASE("Bucket queue against std::priority_queue") {
+        std::mt19937 rng(67);
+        ByteUtilities::BucketQueue<uint32_t> queue;
+        std::priority_queue<std::pair<size_t, uint32_t>, std::vector<std::pair<size_t, uint32_t>>,
+                            std::greater<std::pair<size_t, uint32_t>>>
+            reference;
+        REQUIRE(queue.MinPriority() == queue.npos);
+
+        uint32_t uValue = 0;
+        for (size_t uStep = 0; uStep < 50'000; ++uStep) {
+            if (rng() % 3 != 0 || reference.empty()) {
+                // Priorities clustered near the low end, like a scheduler's deadlines
+                const size_t uPriority = rng() % 2 ? rng() % 64 : rng() % 4096;
+                queue.Push(uPriority, uint32_t(uStep));
+                reference.emplace(uPriority, uint32_t(uStep));
+            } else {
+                size_t uPriority = 0;
+                REQUIRE(queue.MinPriority() == reference.top().first);
+                REQUIRE(queue.PopMin(uValue, &uPriority));
+                REQUIRE(uPriority == reference.top().first);
+                reference.pop();
+            }
+            REQUIRE(queue.Size() == reference.size());
+        }
+
+        size_t uLast = 0;
+        size_t uPriority = 0;
+        while (queue.PopMin(uValue, &uPriority)) {
+            REQUIRE(uPriority >= uLast);
+            uLast = uPriority;
+        }
+        REQUIRE(queue.Empty());
+    }
+
+    TEST_CASE("Bucket queue order within a priority and clear") {
+        ByteUtilities::BucketQueue<std::string, 100> queue;
+        queue.Push(5, std::string("a"));
+        queue.Push(5, std::string("b"));
+        queue.Push(99, std::string("c"));
+        queue.Push(0, std::string("d"));
+        REQUIRE(queue.Top() == "d");
+
+        std::string sValue;
+        REQUIRE(queue.PopMin(sValue));
+        REQUIRE(sValue == "d");
+        REQUIRE(queue.PopMin(sValue));
+        REQUIRE(sValue == "b");
+
+        queue.Clear();
+        REQUIRE(queue.Empty());
+        REQUIRE_FALSE(queue.PopMin(sValue));
+        queue.Push(64, std::string("e"));
+        REQUIRE(queue.MinPriority() == 64);
+    }
+}
+
+/**************************************************************************************
+ * Test Section for [Unaligned integers]
+ **************************************************************************************/
+
+template<size_t _uBytes, std::endian _eEndian>
+static void TestLoadStoreUInt() {
+    std::mt19937_64 rng(68 + _uBytes);
+    std::vector<std::byte> vBuffer(64);
+    for (auto &byte : vBuffer) byte = std::byte(rng());
+    const std::byte *pEnd = vBuffer.data() + vBuffer.size();
+
+    for (size_t uOffset = 0; uOffset + _uBytes <= vBuffer.size(); ++uOffset) {
+        // Reference value assembled byte by byte
+        uint64_t uExpected = 0;
+        for (size_t k = 0; k < _uBytes; ++k) {
+            const uint64_t uByte = std::to_integer<uint8_t>(vBuffer[uOffset + k]);
+            const size_t uShift = _eEndian == std::endian::little ? 8 * k : 8 * (_uBytes - 1 - k);
+            uExpected |= uByte << uShift;
+        }
+        REQUIRE(ByteUtilities::LoadUInt<_uBytes, _eEndian>(vBuffer.data() + uOffset) == uExpected);
+        REQUIRE(ByteUtilities::LoadUInt<_uBytes, _eEndian>(vBuffer.data() + uOffset, pEnd) == uExpected);
+
+        // Both stores only touch their own bytes
+        const uint64_t uValue = rng();
+        const uint64_t uStored = _uBytes == 8 ? uValue : uValue & ((uint64_t(1) << (8 * _uBytes)) - 1);
+        for (const bool bWide : {false, true}) {
+            std::vector<std::byte> vCopy = vBuffer;
+            std::byte *pDst = vCopy.data() + uOffset;
+            if (bWide) ByteUtilities::StoreUInt<_uBytes, _eEndian>(pDst, vCopy.data() + vCopy.size(), uValue);
+            else ByteUtilities::StoreUInt<_uBytes, _eEndian>(pDst, uValue);
+
+            REQUIRE(ByteUtilities::LoadUInt<_uBytes, _eEndian>(vCopy.data() + uOffset) == uStored);
+            for (size_t k = 0; k < vCopy.size(); ++k)
+                if (k < uOffset || k >= uOffset + _uBytes) REQUIRE(vCopy[k] == vBuffer[k]);
+        }
+    }
+}
+
+TEST_SUITE("[Unaligned integers]") {
+    TEST_CASE("Odd width loads and stores") {
+        TestLoadStoreUInt<1, std::endian::little>();
+        TestLoadStoreUInt<3, std::endian::little>();
+        TestLoadStoreUInt<3, std::endian::big>();
+        TestLoadStoreUInt<5, std::endian::little>();
+        TestLoadStoreUInt<5, std::endian::big>();
+        TestLoadStoreUInt<6, std::endian::little>();
+        TestLoadStoreUInt<7, std::endian::big>();
+        TestLoadStoreUInt<8, std::endian::little>();
+        TestLoadStoreUInt<8, std::endian::big>();
+    }
+
+    TEST_CASE("Widen 24 bits arrays") {
+        std::mt19937 rng(68);
+        for (const size_t uCount : {0u, 1u, 5u, 6u, 9u, 10u, 17u, 100u, 1001u}) {
+            // Exact size, the wide loads must not read past the buffer
+            std::vector<std::byte> vPacked(3 * uCount);
+            for (auto &byte : vPacked) byte = std::byte(rng());
+
+            std::vector<uint32_t> vLittle(uCount), vBig(uCount);
+            ByteUtilities::WidenUInt24<std::endian::little>(vPacked.data(), vLittle);
+            ByteUtilities::WidenUInt24<std::endian::big>(vPacked.data(), vBig);
+            for (size_t i = 0; i < uCount; ++i) {
+                const uint32_t uB0 = std::to_integer<uint8_t>(vPacked[3 * i]);
+                const uint32_t uB1 = std::to_integer<uint8_t>(vPacked[3 * i + 1]);
+                const uint32_t uB2 = std::to_integer<uint8_t>(vPacked[3 * i + 2]);
+                REQUIRE(vLittle[i] == (uB0 | uB1 << 8 | uB2 << 16));
+                REQUIRE(vBig[i] == (uB2 | uB1 << 8 | uB0 << 16));
+            }
+        }
+    }
+}
+
+/**************************************************************************************
+ * Test Section for [UTF-8]
+ **************************************************************************************/
+
+/**
+ * @brief Reference decoder, decodes one code point at a time and checks its range.
+ *
+ */
+static bool NaiveDecodeUtf8(std::string_view text, std::u32string &out) {
+    out.clear();
+    for (size_t i = 0; i < text.size();) {
+        const uint8_t uLead = static_cast<uint8_t>(text[i]);
+        size_t uLength = uLead < 0x80 ? 1 : uLead >= 0xF0 ? 4 : uLead >= 0xE0 ? 3 : uLead >= 0xC0 ? 2 : 0;
+        if (uLength == 0 || uLead > 0xF7 || text.size() - i < uLength) return false;
+
+        char32_t uCode = uLength == 1 ? uLead : uLead & (0x7F >> uLength);
+        for (size_t k = 1; k < uLength; ++k) {
+            const uint8_t uByte = static_cast<uint8_t>(text[i + k]);
+            if ((uByte & 0xC0) != 0x80) return false;
+            uCode = (uCode << 6) | (uByte & 0x3F);
+        }
+        const char32_t uMin = uLength == 1 ? 0 : uLength == 2 ? 0x80 : uLength == 3 ? 0x800 : 0x10000;
+        if (uCode < uMin || uCode > 0x10FFFF || (uCode >= 0xD800 && uCode <= 0xDFFF)) return false;
+        out.push_back(uCode);
+        i += uLength;
+    }
+    return true;
+}
+
+/**
+ * @brief Appends the UTF-8 encoding of @ref uCode.
+ *
+ */
+static void AppendUtf8(std::string &text, char32_t uCode) {
+    if (uCode < 0x80) {
+        text.push_back(char(uCode));
+    } else if (uCode < 0x800) {
+        text.push_back(char(0xC0 | uCode >> 6));
+        text.push_back(char(0x80 | (uCode & 0x3F)));
+    } else if (uCode < 0x10000) {
+        text.push_back(char(0xE0 | uCode >> 12));
+        text.push_back(char(0x80 | (uCode >> 6 & 0x3F)));
+        text.push_back(char(0x80 | (uCode & 0x3F)));
+    } else {
+        text.push_back(char(0xF0 | uCode >> 18));
+        text.push_back(char(0x80 | (uCode >> 12 & 0x3F)));
+        text.push_back(char(0x80 | (uCode >> 6 & 0x3F)));
+        text.push_back(char(0x80 | (uCode & 0x3F)));
+    }
+}
+
+TEST_SUITE("[UTF-8]") {
+    TEST_CASE("Validate known sequences") {
+        REQUIRE(ByteUtilities::ValidateUtf8(""));
+        REQUIRE(ByteUtilities::ValidateUtf8("plain ascii"));
+        REQUIRE(ByteUtilities::ValidateUtf8("caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80"));
+        REQUIRE(ByteUtilities::ValidateUtf8("\xed\x9f\xbf"));     // U+D7FF
+        REQUIRE(ByteUtilities::ValidateUtf8("\xf4\x8f\xbf\xbf")); // U+10FFFF
+
+        REQUIRE_FALSE(ByteUtilities::ValidateUtf8("\x80"));             // Lone continuation
+        REQUIRE_FALSE(ByteUtilities::ValidateUtf8("\xc0\xaf"));         // Overlong 2 bytes
+        REQUIRE_FALSE(ByteUtilities::ValidateUtf8("\xe0\x80\xaf"));     // Overlong 3 bytes
+        REQUIRE_FALSE(ByteUtilities::ValidateUtf8("\xf0\x80\x80\xaf")); // Overlong 4 bytes
+        REQUIRE_FALSE(ByteUtilities::ValidateUtf8("\xed\xa0\x80"));     // Surrogate
+        REQUIRE_FALSE(ByteUtilities::ValidateUtf8("\xf4\x90\x80\x80")); // Above U+10FFFF
+        REQUIRE_FALSE(ByteUtilities::ValidateUtf8("\xf5\x80\x80\x80"));
+        REQUIRE_FALSE(ByteUtilities::ValidateUtf8("\xe2\x82"));         // Truncated
+        REQUIRE_FALSE(ByteUtilities::ValidateUtf8("\xc3\xa9\xa9"));     // Too long
+        REQUIRE_FALSE(ByteUtilities::ValidateUtf8("\xff"));
+
+        // Truncated sequences at the end of a full 16 or 32 bytes block
+        for (const size_t uPrefix : {13u, 14u, 15u, 29u, 30u, 31u, 61u, 62u, 63u}) {
+            std::string text(uPrefix, 'a');
+            text += "\xf0\x9f\x98";
+            REQUIRE_FALSE(ByteUtilities::ValidateUtf8(text));
+            text += "\x80";
+            REQUIRE(ByteUtilities::ValidateUtf8(text));
+        }
+    }
+
+    TEST_CASE("Validate against reference") {
+        std::mt19937 rng(69);
+        std::u32string reference;
+        for (size_t uRound = 0; uRound < 3000; ++uRound) {
+            // Mostly valid text with a few random bytes overwritten
+            std::string text;
+            const size_t uCodes = rng() % 80;
+            for (size_t i = 0; i < uCodes; ++i) {
+                const uint32_t uKind = rng() % 4;
+                char32_t uCode = uKind == 0 ? rng() % 0x80 : uKind == 1 ? rng() % 0x800 : rng() % 0x110000;
+                if (uCode >= 0xD800 && uCode <= 0xDFFF) uCode = 'x';
+                AppendUtf8(text, uCode);
+            }
+            const size_t uMutations = text.empty() ? 0 : rng() % 3;
+            for (size_t i = 0; i < uMutations; ++i) text[rng() % text.size()] = char(rng());
+
+            const bool bValid = NaiveDecodeUtf8(text, reference);
+            REQUIRE(ByteUtilities::ValidateUtf8(text) == bValid);
+        }
+    }
+
+    TEST_CASE("Is ASCII") {
+        std::string text(100, 'a');
+        REQUIRE(ByteUtilities::IsAscii(text));
+        for (size_t i = 0; i < text.size(); ++i) {
+            text[i] = char(0x80);
+            REQUIRE_FALSE(ByteUtilities::IsAscii(text));
+            text[i] = 'a';
+        }
+    }
+
+    TEST_CASE("Transcode") {
+        std::mt19937 rng(690);
+        for (size_t uRound = 0; uRound < 500; ++uRound) {
+            std::u32string codes;
+            std::string text;
+            const size_t uCodes = rng() % 200;
+            for (size_t i = 0; i < uCodes; ++i) {
+                // Long ASCII runs to take the wide path
+                char32_t uCode = rng() % 4 ? rng() % 0x80 : rng() % 0x110000;
+                if (uCode >= 0xD800 && uCode <= 0xDFFF) uCode = 0xFFFD;
+                codes.push_back(uCode);
+                AppendUtf8(text, uCode);
+            }
+
+            std::u32string utf32;
+            REQUIRE(ByteUtilities::Utf8ToUtf32(text, utf32));
+            REQUIRE(utf32 == codes);
+
+            std::u16string expected;
+            for (const char32_t uCode : codes) {
+                if (uCode < 0x10000) {
+                    expected.push_back(char16_t(uCode));
+                } else {
+                    expected.push_back(char16_t(0xD800 + ((uCode - 0x10000) >> 10)));
+                    expected.push_back(char16_t(0xDC00 + ((uCode - 0x10000) & 0x3FF)));
+                }
+            }
+            std::u16string utf16;
+            REQUIRE(ByteUtilities::Utf8ToUtf16(text, utf16));
+            REQUIRE(utf16 == expected);
+        }
+
+        std::u16string utf16 = u"stale";
+        REQUIRE_FALSE(ByteUtilities::Utf8ToUtf16("ok\xc0\xaf", utf16));
+        REQUIRE(utf16.empty());
+    }
+
+    TEST_CASE("Transcode 2 bytes sequences and invalid text") {
+        std::mt19937 rng(691);
+        std::u32string reference;
+        for (size_t uRound = 0; uRound < 2000; ++uRound) {
+            // Rounds without long sequences take the 2 bytes path, with a few they mix it with the others
+            std::string text;
+            const size_t uCodes = rng() % 120;
+            const bool bLong = uRound % 3 == 0;
+            for (size_t i = 0; i < uCodes; ++i) {
+                const uint32_t uKind = rng() % 8;
+                char32_t uCode = uKind < 3 ? rng() % 0x80 : 0x80 + rng() % 0x780;
+                if (uKind == 7 && bLong) uCode = rng() % 0x110000;
+                if (uCode >= 0xD800 && uCode <= 0xDFFF) uCode = 0xFFFD;
+                AppendUtf8(text, uCode);
+            }
+            const size_t uMutations = text.empty() || uRound % 4 ? 0 : 1 + rng() % 2;
+            for (size_t i = 0; i < uMutations; ++i) text[rng() % text.size()] = char(rng());
+
+            const bool bValid = NaiveDecodeUtf8(text, reference);
+            std::u32string utf32;
+            REQUIRE(ByteUtilities::Utf8ToUtf32(text, utf32) == bValid);
+            REQUIRE(utf32 == (bValid ? reference : std::u32string()));
+
+            std::u16string utf16;
+            REQUIRE(ByteUtilities::Utf8ToUtf16(text, utf16) == bValid);
+            if (bValid) {
+                std::u32string widened;
+                for (size_t i = 0; i < utf16.size(); ++i) {
+                    char32_t uUnit = utf16[i];
+                    if (uUnit >= 0xD800 && uUnit < 0xDC00)
+                        uUnit = 0x10000 + ((uUnit - 0xD800) << 10) + (utf16[++i] - 0xDC00);
+                    widened.push_back(uUnit);
+                }
+                REQUIRE(widened == reference);
+            }
+        }
+    }
+}
+
+/**************************************************************************************
+ * Test Section for [Lookup tables]
+ **************************************************************************************/
+
+/**
+ * @brief Checks that the Compute and Table policies of the lookup primitives agree.
+ *
+ */
+template<typename T>
+static void TestLookupPolicies(uint64_t uValue) {
+    using LookupPolicy = ByteUtilities::LookupPolicy;
+
+    const T nInt = static_cast<T>(uValue);
+    T nExpected = 0;
+    for (size_t i = 0; i < 8 * sizeof(T); ++i)
+        if (ByteUtilities::GetBit(nInt, i)) nExpected |= T(1u) << (8 * sizeof(T) - 1 - i);
+    REQUIRE(ByteUtilities::ReverseBits<LookupPolicy::Compute>(nInt) == nExpected);
+    REQUIRE(ByteUtilities::ReverseBits<LookupPolicy::Table>(nInt) == nExpected);
+    REQUIRE(ByteUtilities::ReverseBits(nInt) == nExpected);
+
+    REQUIRE(ByteUtilities::PopCount<LookupPolicy::Compute>(nInt) == uint32_t(std::popcount(nInt)));
+    REQUIRE(ByteUtilities::PopCount<LookupPolicy::Table>(nInt) == uint32_t(std::popcount(nInt)));
+}
+
+TEST_SUITE("[Lookup tables]") {
+    TEST_CASE("Generated at compile time") {
+        constexpr auto square = [](size_t i) { return i * i; };
+        using Squares = ByteUtilities::LookupTable<uint16_t, 16, square>;
+        static_assert(Squares::Lookup(7) == 49);
+        static_assert(Squares::BYTES == 32 && Squares::CACHE_LINES == 1);
+        REQUIRE(reinterpret_cast<uintptr_t>(Squares::VALUES.data()) % ByteUtilities::CACHE_LINE_SIZE == 0);
+
+        static_assert(ByteUtilities::ReverseBits<ByteUtilities::LookupPolicy::Table>(uint8_t(0x06)) == 0x60);
+        static_assert(ByteUtilities::PopCount<ByteUtilities::LookupPolicy::Table>(uint32_t(0xF0F0)) == 8);
+        static_assert(ByteUtilities::HexDigitValue<ByteUtilities::LookupPolicy::Table>('F') == 15);
+        static_assert(ByteUtilities::MortonEncode(0b11, 0b00) == 0b0101);
+    }
+
+    TEST_CASE("Policies agree") {
+        std::mt19937_64 rng(70);
+        for (size_t i = 0; i < 2000; ++i) {
+            const uint64_t uValue = rng();
+            TestLookupPolicies<uint8_t>(uValue);
+            TestLookupPolicies<uint16_t>(uValue);
+            TestLookupPolicies<uint32_t>(uValue);
+            TestLookupPolicies<uint64_t>(uValue);
+
+            const uint32_t uX = static_cast<uint32_t>(uValue), uY = static_cast<uint32_t>(uValue >> 32);
+            uint64_t uMorton = 0;
+            for (size_t k = 0; k < 32; ++k)
+                uMorton |= uint64_t(uX >> k & 1) << (2 * k) | uint64_t(uY >> k & 1) << (2 * k + 1);
+            REQUIRE(ByteUtilities::MortonEncode<ByteUtilities::LookupPolicy::Compute>(uX, uY) == uMorton);
+            REQUIRE(ByteUtilities::MortonEncode<ByteUtilities::LookupPolicy::Table>(uX, uY) == uMorton);
+        }
+
+        for (size_t c = 0; c < 256; ++c) {
+            const char cDigit = static_cast<char>(c);
+            const std::string_view digits = "0123456789abcdef";
+            const size_t uPos = digits.find(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+            const uint8_t uExpected = c != 0 && uPos != std::string_view::npos ? uint8_t(uPos) : 0xFF;
+            REQUIRE(ByteUtilities::HexDigitValue<ByteUtilities::LookupPolicy::Compute>(cDigit) == uExpected);
+            REQUIRE(ByteUtilities::HexDigitValue<ByteUtilities::LookupPolicy::Table>(cDigit) == uExpected);
+        }
+    }
+
+    TEST_CASE("CRC-32C") {
+        constexpr std::string_view check = "123456789";
+        const std::span<const uint8_t> bytes(reinterpret_cast<const uint8_t *>(check.data()), check.size());
+        REQUIRE(ByteUtilities::Crc32c<ByteUtilities::LookupPolicy::Compute>(bytes) == 0xE3069283u);
+        REQUIRE(ByteUtilities::Crc32c<ByteUtilities::LookupPolicy::Table>(bytes) == 0xE3069283u);
+        REQUIRE(ByteUtilities::Crc32c({}) == 0u);
+
+        std::mt19937 rng(700);
+        std::vector<uint8_t> vData(1000);
+        for (auto &uByte : vData) uByte = static_cast<uint8_t>(rng());
+        const uint32_t uWhole = ByteUtilities::Crc32c<ByteUtilities::LookupPolicy::Table>(vData);
+        REQUIRE(ByteUtilities::Crc32c<ByteUtilities::LookupPolicy::Compute>(vData) == uWhole);
+
+        // In pieces
+        const std::span<const uint8_t> data(vData);
+        uint32_t uCrc = ByteUtilities::Crc32c(data.first(333));
+        uCrc = ByteUtilities::Crc32c(data.subspan(333), uCrc);
+        REQUIRE(uCrc == uWhole);
+    }
+}
+
+/**************************************************************************************
+ * Test Section for [Incremental decoding]
+ **************************************************************************************/
+
+/**
+ * @brief Reads every field of @ref vWidths into @ref vOut, then counts the bits left before the end.
+ *
+ */
+static ByteUtilities::BitStreamDecoder::Task DecodeFields(ByteUtilities::BitStreamDecoder &decoder,
+                                                          const std::vector<size_t> &vWidths,
+                                                          std::vector<uint64_t> &vOut, size_t &uTrailingBits) {
+    for (const size_t uWidth : vWidths) vOut.push_back(co_await decoder.ReadBits(uWidth));
+    while (!co_await decoder.AtEnd()) uTrailingBits += (co_await decoder.ReadBits(1), 1);
+}
+
+/**
+ * @brief Same as @ref DecodeFields, reading with ReadBatch and only the fields it stops at with ReadBits.
+ *
+ */
+static ByteUtilities::BitStreamDecoder::Task DecodeFieldsBatched(ByteUtilities::BitStreamDecoder &decoder,
+                                                                 const std::vector<uint8_t> &vWidths,
+                                                                 std::vector<uint64_t> &vOut) {
+    vOut.assign(vWidths.size(), 0);
+    for (size_t i = 0; i < vWidths.size(); ++i) {
+        i += decoder.ReadBatch(std::span(vWidths).subspan(i), std::span(vOut).subspan(i));
+        if (i < vWidths.size()) vOut[i] = co_await decoder.ReadBits(vWidths[i]);
+    }
+}
+
+/**
+ * @brief Same as @ref DecodeFields, co_awaiting ReadFields on batches of @ref uBatch fields.
+ *
+ */
+static ByteUtilities::BitStreamDecoder::Task DecodeFieldsAwaited(ByteUtilities::BitStreamDecoder &decoder,
+                                                                 const std::vector<uint8_t> &vWidths,
+                                                                 std::vector<uint64_t> &vOut, size_t uBatch) {
+    vOut.assign(vWidths.size(), 0);
+    for (size_t i = 0; i < vWidths.size(); i += uBatch) {
+        const size_t uCount = std::min(uBatch, vWidths.size() - i);
+        co_await decoder.ReadFields(std::span(vWidths).subspan(i, uCount), std::span(vOut).subspan(i, uCount));
+    }
+}
+
+/**
+ * @brief Random fields of 0 to 64 bits and their LSB first encoding.
+ *
+ */
+static void MakeFields(std::mt19937_64 &rng, size_t uCount, std::vector<size_t> &vWidths,
+                       std::vector<uint64_t> &vValues, std::vector<uint8_t> &vBytes) {
+    vWidths.clear();
+    vValues.clear();
+    vBytes.clear();
+    uint64_t uBit = 0;
+    for (size_t i = 0; i < uCount; ++i) {
+        const size_t uWidth = rng() % 4 ? rng() % 20 : rng() % 65;
+        const uint64_t uValue = uWidth == 64 ? rng() : rng() & ((uint64_t(1u) << uWidth) - 1);
+        vWidths.push_back(uWidth);
+        vValues.push_back(uValue);
+        for (size_t k = 0; k < uWidth; ++k, ++uBit) {
+            if (uBit % 8 == 0) vBytes.push_back(0);
+            vBytes.back() |= uint8_t((uValue >> k) & 1u) << (uBit % 8);
+        }
+    }
+}
+
+TEST_SUITE("[Incremental decoding]") {
+    TEST_CASE("Fields straddling chunks") {
+        std::mt19937_64 rng(71);
+        std::vector<size_t> vWidths;
+        std::vector<uint64_t> vValues;
+        std::vector<uint8_t> vBytes;
+        for (size_t uRound = 0; uRound < 300; ++uRound) {
+            MakeFields(rng, rng() % 200, vWidths, vValues, vBytes);
+
+            ByteUtilities::BitStreamDecoder decoder;
+            std::vector<uint64_t> vOut;
+            size_t uTrailingBits = 0;
+            auto task = DecodeFields(decoder, vWidths, vOut, uTrailingBits);
+
+            // Chunks of 0 to 20 bytes, each one copied so it dies after Feed
+            size_t uPos = 0;
+            while (uPos < vBytes.size()) {
+                const size_t uSize = std::min<size_t>(rng() % 21, vBytes.size() - uPos);
+                std::vector<uint8_t> vChunk(vBytes.begin() + uPos, vBytes.begin() + uPos + uSize);
+                REQUIRE(decoder.Feed(vChunk));
+                uPos += uSize;
+            }
+            REQUIRE_FALSE(task.Done());
+            decoder.Finish();
+
+            REQUIRE(task.Done());
+            REQUIRE_FALSE(decoder.Overrun());
+            REQUIRE(vOut == vValues);
+
+            size_t uBits = 0;
+            for (const size_t uWidth : vWidths) uBits += uWidth;
+            REQUIRE(uTrailingBits == 8 * vBytes.size() - uBits);
+        }
+    }
+
+    TEST_CASE("Whole stream in one chunk") {
+        std::mt19937_64 rng(710);
+        std::vector<size_t> vWidths;
+        std::vector<uint64_t> vValues;
+        std::vector<uint8_t> vBytes;
+        MakeFields(rng, 5000, vWidths, vValues, vBytes);
+
+        ByteUtilities::BitStreamDecoder decoder;
+        std::vector<uint64_t> vOut;
+        size_t uTrailingBits = 0;
+        auto task = DecodeFields(decoder, vWidths, vOut, uTrailingBits);
+        REQUIRE(decoder.Feed(vBytes));
+        decoder.Finish();
+        REQUIRE(task.Done());
+        REQUIRE(vOut == vValues);
+    }
+
+    TEST_CASE("ReadBatch and ReadFields between suspensions") {
+        std::mt19937_64 rng(711);
+        std::vector<size_t> vWidths;
+        std::vector<uint64_t> vValues;
+        std::vector<uint8_t> vBytes;
+        for (size_t uRound = 0; uRound < 200; ++uRound) {
+            MakeFields(rng, rng() % 2000, vWidths, vValues, vBytes);
+            const std::vector<uint8_t> vNarrowWidths(vWidths.begin(), vWidths.end());
+
+            ByteUtilities::BitStreamDecoder decoder;
+            std::vector<uint64_t> vOut;
+            auto task = uRound % 2 ? DecodeFieldsAwaited(decoder, vNarrowWidths, vOut, 1 + rng() % 300)
+                                   : DecodeFieldsBatched(decoder, vNarrowWidths, vOut);
+
+            // Chunks of 0 to 100 bytes, the batch stops within the last 8 bytes of every one
+            size_t uPos = 0;
+            while (uPos < vBytes.size()) {
+                const size_t uSize = std::min<size_t>(rng() % 101, vBytes.size() - uPos);
+                std::vector<uint8_t> vChunk(vBytes.begin() + uPos, vBytes.begin() + uPos + uSize);
+                decoder.Feed(vChunk);
+                uPos += uSize;
+            }
+            decoder.Finish();
+
+            REQUIRE(task.Done());
+            REQUIRE_FALSE(decoder.Overrun());
+            REQUIRE(vOut == vValues);
+        }
+    }
+
+    TEST_CASE("Overrun and early return") {
+        ByteUtilities::BitStreamDecoder decoder;
+        std::vector<uint64_t> vOut;
+        size_t uTrailingBits = 0;
+        const std::vector<size_t> vWidths = {12, 12};
+        auto task = DecodeFields(decoder, vWidths, vOut, uTrailingBits);
+        const std::vector<uint8_t> vChunk = {0xAB, 0xCD};
+        REQUIRE(decoder.Feed(vChunk));
+        decoder.Finish();
+        REQUIRE(task.Done());
+        REQUIRE(decoder.Overrun());
+        REQUIRE(vOut == std::vector<uint64_t>{0xDAB, 0x00C});
+
+        // A batch waiting for its last field when the stream finishes
+        ByteUtilities::BitStreamDecoder batched;
+        const std::vector<uint8_t> vBatchWidths = {4, 8, 12};
+        auto batchedTask = DecodeFieldsAwaited(batched, vBatchWidths, vOut, 3);
+        REQUIRE(batched.Feed(vChunk));
+        REQUIRE_FALSE(batchedTask.Done());
+        batched.Finish();
+        REQUIRE(batchedTask.Done());
+        REQUIRE(batched.Overrun());
+        REQUIRE(vOut == std::vector<uint64_t>{0xB, 0xDA, 0x00C});
+
+        // The coroutine returns while the chunk still has bytes
+        ByteUtilities::BitStreamDecoder other;
+        auto single = [](ByteUtilities::BitStreamDecoder &decoder,
+                         uint64_t &uValue) -> ByteUtilities::BitStreamDecoder::Task {
+            uValue = co_await decoder.ReadBits(4);
+        };
+        uint64_t uValue = 0;
+        auto singleTask = single(other, uValue);
+        REQUIRE_FALSE(other.Feed(vChunk));
+        REQUIRE(singleTask.Done());
+        REQUIRE(uValue == 0xB);
+    }
+}
+
+/**************************************************************************************
+ * Test Section for [Thread pool]
+ **************************************************************************************/
+
+/**
+ * @brief Runs ParallelFor over [uBegin, uEnd) and checks that every index was visited exactly once, by
+ * chunks of at most uGrain indexes.
+ *
+ */
+static bool VisitsOnce(ByteUtilities::ThreadPool &pool, size_t uBegin, size_t uEnd, size_t uGrain) {
+    std::vector<std::atomic<uint32_t>> vVisits(uEnd);
+    std::atomic<bool> bChunksFit = true;
+    pool.ParallelFor(uBegin, uEnd, uGrain, [&](size_t uChunkBegin, size_t uChunkEnd) {
+        if (uChunkEnd - uChunkBegin > std::max<size_t>(uGrain, 1)) bChunksFit = false;
+        for (size_t i = uChunkBegin; i < uChunkEnd; ++i) vVisits[i].fetch_add(1, std::memory_order_relaxed);
+    });
+    for (size_t i = 0; i < uEnd; ++i)
+        if (vVisits[i].load() != (i >= uBegin ? 1u : 0u)) return false;
+    return bChunksFit;
+}
+
+TEST_SUITE("[Thread pool]") {
+    TEST_CASE("ParallelFor visits every index once") {
+        for (const size_t uWorkers : {0u, 1u, 4u}) {
+            ByteUtilities::ThreadPool pool(uWorkers);
+            REQUIRE(pool.Workers() == uWorkers);
+            REQUIRE(VisitsOnce(pool, 0, 0, 1));
+            REQUIRE(VisitsOnce(pool, 0, 1, 1));
+            REQUIRE(VisitsOnce(pool, 3, 10, 0));
+            REQUIRE(VisitsOnce(pool, 0, 100000, 1));
+            REQUIRE(VisitsOnce(pool, 5, 100000, 7));
+            REQUIRE(VisitsOnce(pool, 0, 100000, 100000));
+            // More chunks than a deque holds
+            REQUIRE(VisitsOnce(pool, 0, 1 << 20, 16));
+        }
+    }
+
+    TEST_CASE("Nested and concurrent ParallelFor") {
+        ByteUtilities::ThreadPool pool(3);
+        std::atomic<uint64_t> uSum = 0;
+        pool.ParallelFor(0, 64, 1, [&](size_t uBegin, size_t uEnd) {
+            for (size_t i = uBegin; i < uEnd; ++i)
+                pool.ParallelFor(0, 1000, 10, [&](size_t uInnerBegin, size_t uInnerEnd) {
+                    uint64_t uLocal = 0;
+                    for (size_t j = uInnerBegin; j < uInnerEnd; ++j) uLocal += i * 1000 + j;
+                    uSum.fetch_add(uLocal, std::memory_order_relaxed);
+                });
+        });
+        REQUIRE(uSum.load() == 64000ull * 63999 / 2);
+
+        // External threads share the pool
+        std::vector<std::thread> vThreads;
+        std::atomic<bool> bAllVisited = true;
+        for (size_t t = 0; t < 4; ++t)
+            vThreads.emplace_back([&] {
+                if (!VisitsOnce(pool, 0, 50000, 3)) bAllVisited = false;
+            });
+        for (std::thread &thread : vThreads) thread.join();
+        REQUIRE(bAllVisited.load());
+    }
+
+    TEST_CASE("Submit") {
+        std::atomic<size_t> uDone = 0;
+        {
+            ByteUtilities::ThreadPool pool(2, true);
+            for (size_t i = 0; i < 1000; ++i) pool.Submit([&] { uDone.fetch_add(1); });
+        }
+        REQUIRE(uDone.load() == 1000);
+
+        // Without workers, jobs run on the threads helping the pool
+        ByteUtilities::ThreadPool pool(0);
+        pool.Submit([&] { uDone.fetch_add(1); });
+        REQUIRE(uDone.load() == 1000);
+        REQUIRE(pool.TryRunOne());
+        REQUIRE_FALSE(pool.TryRunOne());
+        REQUIRE(uDone.load() == 1001);
+    }
+}
+
+/**************************************************************************************
+ * Test Section for [Block decoding]
+ **************************************************************************************/
+
+/**
+ * @brief Encodes @ref uBlocks random blocks into @ref vFile, mixing small and wide values so both
+ * payload kinds show up, and keeps their values in @ref vBlocks.
+ *
+ */
+static void MakeBlockFile(std::mt19937_64 &rng, size_t uBlocks, std::vector<std::vector<uint64_t>> &vBlocks,
+                          std::vector<uint8_t> &vFile) {
+    vBlocks.assign(uBlocks, {});
+    vFile.clear();
+    for (auto &vValues : vBlocks) {
+        const size_t uWidth = 1 + rng() % 64;
+        const bool bOutliers = rng() % 3 == 0;
+        vValues.resize(rng() % 300);
+        for (auto &uValue : vValues) {
+            uValue = uWidth == 64 ? rng() : rng() & ((uint64_t(1u) << uWidth) - 1);
+            if (bOutliers) uValue = rng() % 50 ? uValue % 100 : rng();
+        }
+        ByteUtilities::EncodeBlock(std::span<const uint64_t>(vValues), vFile);
+    }
+}
+
+/**
+ * @brief Allocations above this size throw std::bad_alloc, on every thread, see the replaced operator
+ * new below. The replacements are not inlined, GCC would then pair the malloc and free with the new and
+ * delete expressions and warn about a mismatch.
+ *
+ */
+static std::atomic<size_t> g_uAllocationLimit = std::numeric_limits<size_t>::max();
+
+[[gnu::noinline]] void *operator new(size_t uSize) {
+    if (uSize > g_uAllocationLimit.load(std::memory_order_relaxed)) throw std::bad_alloc();
+    if (void *p = std::malloc(uSize ? uSize : 1)) return p;
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void *p, size_t) noexcept {
+    std::free(p);
+}
+
+TEST_SUITE("[Block decoding]") {
+    TEST_CASE("Encode and decode one block") {
+        std::mt19937_64 rng(72);
+        std::vector<std::vector<uint64_t>> vBlocks;
+        std::vector<uint8_t> vFile;
+        MakeBlockFile(rng, 200, vBlocks, vFile);
+
+        std::span<const uint8_t> rest(vFile);
+        for (const auto &vExpected : vBlocks) {
+            std::vector<uint64_t> vValues;
+            const size_t uSize = ByteUtilities::DecodeBlock(rest, vValues);
+            REQUIRE(uSize > 0);
+            REQUIRE(vValues == vExpected);
+            rest = rest.subspan(uSize);
+        }
+        REQUIRE(rest.empty());
+
+        // Small values are bit-packed, a few large ones among small ones are varints
+        std::vector<uint8_t> vSmall;
+        ByteUtilities::EncodeBlock(std::span<const uint64_t>(std::vector<uint64_t>(100, 3)), vSmall);
+        REQUIRE(vSmall.size() == 3 + 25);
+        REQUIRE(vSmall[2] == 2);
+
+        std::vector<uint64_t> vOutliers(100, 1);
+        vOutliers[7] = std::numeric_limits<uint64_t>::max();
+        std::vector<uint8_t> vVarint;
+        ByteUtilities::EncodeBlock(std::span<const uint64_t>(vOutliers), vVarint);
+        REQUIRE(vVarint[2] == 0xFF);
+        std::vector<uint64_t> vDecoded;
+        REQUIRE(ByteUtilities::DecodeBlock(vVarint, vDecoded) == vVarint.size());
+        REQUIRE(vDecoded == vOutliers);
+    }
+
+    TEST_CASE("Malformed blocks") {
+        std::vector<uint8_t> vBlock;
+        ByteUtilities::EncodeBlock(std::span<const uint64_t>(std::vector<uint64_t>{1, 2, 3, 4}), vBlock);
+        std::vector<uint64_t> vValues;
+        for (size_t uSize = 0; uSize < vBlock.size(); ++uSize)
+            REQUIRE(ByteUtilities::DecodeBlock(std::span(vBlock.data(), uSize), vValues) == 0);
+
+        // A count that does not fit the payload must not allocate it
+        const std::vector<uint8_t> vHuge = {0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x0F, 0x01, 0x00};
+        REQUIRE(ByteUtilities::DecodeBlock(vHuge, vValues) == 0);
+        const std::vector<uint8_t> vBadWidth = {0x01, 0x01, 0x41, 0x00};
+        REQUIRE(ByteUtilities::DecodeBlock(vBadWidth, vValues) == 0);
+    }
+
+    TEST_CASE("Pipeline delivers in order") {
+        std::mt19937_64 rng(720);
+        std::vector<std::vector<uint64_t>> vBlocks;
+        std::vector<uint8_t> vFile;
+        MakeBlockFile(rng, 3000, vBlocks, vFile);
+        REQUIRE(vFile.size() > (size_t(1u) << 18));
+
+        for (const size_t uWorkers : {0u, 1u, 3u}) {
+            ByteUtilities::ThreadPool pool(uWorkers);
+            for (const size_t uBatch : {1u, 7u, 64u}) {
+                for (const size_t uDepth : {1u, 3u, 32u}) {
+                    size_t uNext = 0;
+                    bool bMatch = true;
+                    const bool bDecoded = ByteUtilities::DecodeBlocks(
+                        vFile,
+                        [&](size_t uBlock, std::span<const uint64_t> values) {
+                            bMatch = bMatch && uBlock == uNext && uBlock < vBlocks.size() &&
+                                     std::equal(values.begin(), values.end(), vBlocks[uBlock].begin(),
+                                                vBlocks[uBlock].end());
+                            ++uNext;
+                        },
+                        pool, uBatch, uDepth);
+                    REQUIRE(bDecoded);
+                    REQUIRE(bMatch);
+                    REQUIRE(uNext == vBlocks.size());
+                }
+            }
+        }
+
+        // Truncated in the middle of a block: every block before it is delivered
+        const std::span<const uint8_t> truncated(vFile.data(), vFile.size() - 1);
+        size_t uDelivered = 0;
+        ByteUtilities::ThreadPool pool(4);
+        REQUIRE_FALSE(ByteUtilities::DecodeBlocks(
+            truncated, [&](size_t, std::span<const uint64_t>) { ++uDelivered; }, pool, 8, 4));
+        REQUIRE(uDelivered == vBlocks.size() - 1);
+    }
+
+    TEST_CASE("Allocation failure on a worker") {
+        std::mt19937_64 rng(7201);
+        std::vector<std::vector<uint64_t>> vBlocks;
+        std::vector<uint8_t> vFile, vSecondHalf;
+        MakeBlockFile(rng, 1500, vBlocks, vSecondHalf);
+        MakeBlockFile(rng, 1500, vBlocks, vFile);
+
+        // Between the halves, a valid block of 1 bit values whose 1.6 MB of values exceed the limit
+        ByteUtilities::EncodeBlock(std::span<const uint64_t>(std::vector<uint64_t>(200'000, 1)), vFile);
+        vFile.insert(vFile.end(), vSecondHalf.begin(), vSecondHalf.end());
+
+        ByteUtilities::ThreadPool pool(3);
+        for (const size_t uDepth : {1u, 8u}) {
+            size_t uDelivered = 0;
+            bool bThrown = false;
+            g_uAllocationLimit = size_t(1u) << 20;
+            try {
+                static_cast<void>(ByteUtilities::DecodeBlocks(
+                    vFile, [&](size_t, std::span<const uint64_t>) { ++uDelivered; }, pool, 4, uDepth));
+            } catch (const std::bad_alloc &) {
+                bThrown = true;
+            }
+            g_uAllocationLimit = std::numeric_limits<size_t>::max();
+            REQUIRE(bThrown);
+            REQUIRE(uDelivered <= vBlocks.size());
+        }
+
+        // The pool is still usable
+        size_t uDelivered = 0;
+        REQUIRE(ByteUtilities::DecodeBlocks(
+            vFile, [&](size_t, std::span<const uint64_t>) { ++uDelivered; }, pool, 4, 8));
+        REQUIRE(uDelivered == 2 * vBlocks.size() + 1);
+    }
+
+    TEST_CASE("Decode a file") {
+        std::mt19937_64 rng(7200);
+        std::vector<std::vector<uint64_t>> vBlocks;
+        std::vector<uint8_t> vFile;
+        MakeBlockFile(rng, 2000, vBlocks, vFile);
+
+        const std::string path = "ByteUtilitiesBlocks.tmp";
+        std::FILE *pFile = std::fopen(path.c_str(), "wb");
+        REQUIRE(pFile);
+        REQUIRE(std::fwrite(vFile.data(), 1, vFile.size(), pFile) == vFile.size());
+        std::fclose(pFile);
+
+        uint64_t uSum = 0, uExpected = 0;
+        for (const auto &vValues : vBlocks)
+            for (const uint64_t uValue : vValues) uExpected += uValue;
+        REQUIRE(ByteUtilities::DecodeBlockFile(
+            path.c_str(),
+            [&](size_t, std::span<const uint64_t> values) {
+                for (const uint64_t uValue : values) uSum += uValue;
+            }));
+        REQUIRE(uSum == uExpected);
+        std::remove(path.c_str());
+
+        REQUIRE_FALSE(ByteUtilities::DecodeBlockFile("does/not/exist", [](size_t, std::span<const uint64_t>) {}));
+    }
+}
+
+/**************************************************************************************
+ * Test Section for [Sharded bitmap]
+ **************************************************************************************/
+
+/**
+ * @brief Bits set by the shard uShard of a bitmap of uSize bits, some shared with the other shards.
+ *
+ */
+static std::vector<size_t> ShardBits(size_t uShard, size_t uSize) {
+    std::mt19937_64 rng(740 + uShard);
+    std::vector<size_t> vBits(2000);
+    for (size_t &uBit : vBits) {
+        const size_t uRange = rng() % 3 == 0 ? std::min<size_t>(uSize, 64) : uSize;
+        uBit = rng() % uRange;
+    }
+    return vBits;
+}
+
+TEST_SUITE("[Sharded bitmap]") {
+    TEST_CASE("Merge ORs every shard") {
+        for (const size_t uSize : {1u, 63u, 64u, 1000u, 300000u}) {
+            for (const size_t uWorkers : {0u, 3u}) {
+                ByteUtilities::ThreadPool pool(uWorkers);
+                ByteUtilities::ShardedBitmap bitmap(uSize, 4);
+                REQUIRE(bitmap.Shards() == 4);
+                REQUIRE(bitmap.Words().size() == (uSize + 63) / 64);
+
+                std::vector<bool> vExpected(uSize, false);
+                std::vector<std::thread> vWriters;
+                for (size_t t = 0; t < 4; ++t) {
+                    for (const size_t uBit : ShardBits(t, uSize)) vExpected[uBit] = true;
+                    vWriters.emplace_back([&bitmap, t, uSize] {
+                        for (const size_t uBit : ShardBits(t, uSize)) bitmap.SetBit(t, uBit);
+                    });
+                }
+                for (std::thread &writer : vWriters) writer.join();
+
+                // Nothing merged yet, the live reads see the shards
+                REQUIRE(bitmap.Count() == 0);
+                REQUIRE_FALSE(bitmap.Test(ShardBits(0, uSize)[0]));
+                REQUIRE(bitmap.TestLive(ShardBits(0, uSize)[0]));
+
+                bitmap.Merge(pool);
+                bool bMatch = true;
+                for (size_t i = 0; i < uSize; ++i)
+                    bMatch = bMatch && bitmap.Test(i) == vExpected[i] && bitmap.TestLive(i) == vExpected[i];
+                REQUIRE(bMatch);
+                REQUIRE(bitmap.Count() == static_cast<uint64_t>(std::count(vExpected.begin(), vExpected.end(), true)));
+
+                // A second epoch adds to the first
+                bitmap.SetBit(2, uSize - 1);
+                bitmap.Merge(pool);
+                REQUIRE(bitmap.Test(uSize - 1));
+
+                bitmap.Clear();
+                REQUIRE(bitmap.Count() == 0);
+                REQUIRE_FALSE(bitmap.TestLive(uSize - 1));
+            }
+        }
+    }
+}
+
+/**************************************************************************************
+ * Test Section for [Concurrent Bloom filter]
+ **************************************************************************************/
+
+TEST_SUITE("[Concurrent Bloom filter]") {
+    TEST_CASE("No false negatives and a bounded false positive rate") {
+        std::mt19937_64 rng(750);
+        std::vector<uint64_t> vKeys(100000);
+        for (uint64_t &uKey : vKeys) uKey = rng();
+
+        ByteUtilities::ConcurrentBloomFilter filter(16 * vKeys.size());
+        REQUIRE(filter.Bits() % 512 == 0);
+        REQUIRE(filter.Bits() >= 16 * vKeys.size());
+        std::vector<std::thread> vWriters;
+        for (size_t t = 0; t < 4; ++t)
+            vWriters.emplace_back([&, t] {
+                const std::span<const uint64_t> keys(vKeys);
+                const size_t uShare = keys.size() / 4;
+                if (t % 2 == 0) {
+                    filter.InsertBatch(keys.subspan(t * uShare, uShare));
+                } else {
+                    for (const uint64_t uKey : keys.subspan(t * uShare, uShare)) filter.Insert(uKey);
+                }
+            });
+        for (std::thread &writer : vWriters) writer.join();
+
+        bool bAllFound = true;
+        for (const uint64_t uKey : vKeys) bAllFound = bAllFound && filter.MayContain(uKey);
+        REQUIRE(bAllFound);
+
+        std::vector<uint64_t> vOthers(100000);
+        for (uint64_t &uKey : vOthers) uKey = rng();
+        std::vector<uint64_t> vHits((vOthers.size() + 63) / 64, ~uint64_t(0));
+        const size_t uFalsePositives = filter.MayContainBatch(vOthers, vHits.data());
+        REQUIRE(uFalsePositives < vOthers.size() / 200);
+
+        // The batch probe agrees with the single one
+        bool bMatch = true;
+        size_t uCount = 0;
+        for (size_t i = 0; i < vOthers.size(); ++i) {
+            const bool bHit = (vHits[i / 64] >> (i % 64)) & 1u;
+            bMatch = bMatch && bHit == filter.MayContain(vOthers[i]);
+            uCount += bHit;
+        }
+        REQUIRE(bMatch);
+        REQUIRE(uCount == uFalsePositives);
+        REQUIRE(filter.MayContainBatch(std::span<const uint64_t>(vKeys).first(1000), vHits.data()) == 1000);
+
+        filter.Clear();
+        REQUIRE(filter.MayContainBatch(std::span<const uint64_t>(vKeys).first(1000), vHits.data()) == 0);
+    }
+
+    TEST_CASE("Probes see the inserts that happen before them") {
+        ByteUtilities::ConcurrentBloomFilter filter(1 << 16);
+        std::atomic<size_t> uInserted = 0;
+        std::thread writer([&] {
+            for (uint64_t uKey = 0; uKey < 20000; ++uKey) {
+                filter.Insert(uKey * 0x9E3779B97F4A7C15u);
+                uInserted.store(uKey + 1, std::memory_order_release);
+            }
+        });
+        bool bAllFound = true;
+        for (size_t uSeen = 0; uSeen < 20000;) {
+            uSeen = uInserted.load(std::memory_order_acquire);
+            for (size_t k = 0; k < 16 && k < uSeen; ++k)
+                bAllFound = bAllFound && filter.MayContain((uSeen - 1 - k) * 0x9E3779B97F4A7C15u);
+        }
+        writer.join();
+        REQUIRE(bAllFound);
+        REQUIRE(filter.Bits() == size_t(1) << 16);
+    }
+}